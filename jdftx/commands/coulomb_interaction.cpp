@@ -37,6 +37,12 @@ EnumStringMap<CoulombParams::Geometry> truncationTypeMap
 	CoulombParams::Spherical,   "Spherical"
 );
 
+EnumStringMap<CoulombParams::EwaldMethod> ewaldMethodMap
+(	CoulombParams::EwaldAuto,         "Auto",
+	CoulombParams::EwaldDirect,       "Direct",
+	CoulombParams::EwaldParticleMesh, "ParticleMesh"
+);
+
 EnumStringMap<int> truncationDirMap
 (	0, "100",
 	1, "010",
@@ -181,6 +187,42 @@ struct CommandCoulombTruncationIonMargin : public Command
 commandCoulombTruncationIonMargin;
 
 
+struct CommandCoulombEwaldMethod : public Command
+{
+	CommandCoulombEwaldMethod() : Command("coulomb-ewald-method", "jdftx/Coulomb interactions")
+	{
+		format = "<method>=" + ewaldMethodMap.optionList();
+		comments =
+			"Method for the reciprocal-space part of the Ewald sum for the ion-ion\n"
+			"interaction in the 3D periodic geometry. The allowed methods are:\n"
+			"\n+ Auto\n\n"
+			"    Select between Direct and ParticleMesh based on the estimated cost\n"
+			"    for the number of atoms in the unit cell (default).\n"
+			"\n+ Direct\n\n"
+			"    Explicit sum over reciprocal lattice vectors, with cost ~ Natoms^2.\n"
+			"\n+ ParticleMesh\n\n"
+			"    Smooth particle-mesh Ewald that spreads the point charges onto the\n"
+			"    fftbox using B-splines, with cost ~ Natoms + fftbox FFTs. Relative\n"
+			"    errors in energies and forces are ~1e-10 compared to Direct.\n"
+			"\n"
+			"Truncated geometries (see coulomb-interaction) always use their direct sums.";
+		hasDefault = false;
+		require("coulomb-interaction");
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.coulombParams.ewaldMethod, CoulombParams::EwaldAuto, ewaldMethodMap, "method", true);
+		if(e.coulombParams.ewaldMethod==CoulombParams::EwaldParticleMesh && e.coulombParams.geometry!=CoulombParams::Periodic)
+			throw string("<method> = ParticleMesh is only supported for coulomb-interaction Periodic");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", ewaldMethodMap.getString(e.coulombParams.ewaldMethod));
+	}
+}
+commandCoulombEwaldMethod;
+
+
 struct CommandExchangeRegularization : public Command
 {
 	CommandExchangeRegularization() : Command("exchange-regularization", "jdftx/Coulomb interactions")
@@ -105,6 +105,12 @@ struct CommandDensityOfStates : public Command
 			"   the typical level spacing. This flag affects all columns of output,\n"
 			"   and is 0 by default. Warning: if finite but too small, output size\n"
 			"   might be dangerously large; if non-zero, recommend at least 1e-4.\n"
+			"\n+ WeightBatch <nWeights>\n\n"
+			"   Process at most nWeights columns together in the tetrahedron method,\n"
+			"   streaming through the columns in batches that share the welded\n"
+			"   eigenvalues and energy grid. This reduces the memory required for\n"
+			"   many projected columns on dense k-meshes, and does not change the\n"
+			"   output. Default 0 processes all columns together.\n"
 			"\n+ Occupied\n\n"
 			"   All subsequent columns are occupied density of states, that is\n"
 			"   they are weighted by the band fillings.\n"
@@ -144,6 +150,11 @@ struct CommandDensityOfStates : public Command
 			//Check if it is a flag:
 			if(key == "Etol") { pl.get(dos.Etol, 0., "Etol", true); continue; }
 			if(key == "Esigma") { pl.get(dos.Esigma, 0., "Esigma", true); continue; }
+			if(key == "WeightBatch")
+			{	pl.get(dos.weightBatch, 0, "nWeights", true);
+				if(dos.weightBatch < 0) throw string("WeightBatch <nWeights> must be non-negative");
+				continue;
+			}
 			if(key == "Occupied") { fillingMode = DOS::Weight::Occupied; continue; }
 			if(key == "Complete") { fillingMode = DOS::Weight::Complete; continue; }
 			if(key == "SpinProjected")
@@ -233,6 +244,7 @@ struct CommandDensityOfStates : public Command
 		DOS::Weight::FillingMode fillingMode = DOS::Weight::Complete;
 		vector3<> Mhat;
 		logPrintf("Etol %le Esigma %le", dos.Etol, dos.Esigma);
+		if(dos.weightBatch) logPrintf(" WeightBatch %d", dos.weightBatch);
 		for(unsigned iWeight=0; iWeight<dos.weights.size(); iWeight++)
 		{	const DOS::Weight& weight = dos.weights[iWeight];
 			//Check for changed filling mode:
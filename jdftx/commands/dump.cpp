@@ -259,6 +259,42 @@ struct CommandDumpInterval : public Command
 }
 commandDumpInterval;
 
+//-------------------------------------------------------------------------------------------------
+
+struct CommandCheckpoint : public Command
+{
+	CommandCheckpoint() : Command("checkpoint", "jdftx/Output")
+	{
+		format = "<interval> [<filename-pattern>=checkpoint.$VAR]";
+		comments =
+			"Checkpoint the state every <interval> electronic (SCF or minimizer) iterations,\n"
+			"so that preempted calculations can be resumed mid-minimization.\n"
+			"Wavefunctions, fillings and eigenvalues (when fillings are variable), SCF history,\n"
+			"lattice vectors and ionic positions are snapshotted in memory and then written by a background\n"
+			"thread, so the calculation does not stall during the write. Files are first written\n"
+			"with a .tmp suffix and renamed only once complete on all processes, so that the\n"
+			"last committed checkpoint is always consistent. If a write has not completed\n"
+			"by the next checkpoint, that checkpoint is skipped. If any file cannot be written,\n"
+			"a warning is printed and the previous checkpoint is left in place.\n"
+			"To resume, use initial-state <filename-pattern> and include the lattice and ionpos files.\n"
+			"The state of the fluid, if any, is not checkpointed (use dump for that).";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.checkpoint.interval, 0, "interval", true);
+		if(e.checkpoint.interval<1)
+			throw string("<interval> must be a positive integer");
+		pl.get(e.checkpoint.filenamePattern, string("checkpoint.$VAR"), "filename-pattern");
+		if(e.checkpoint.filenamePattern.find("$VAR")==string::npos)
+			throw "<filename-pattern> = " + e.checkpoint.filenamePattern + " doesn't contain '$VAR'";
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d %s", e.checkpoint.interval, e.checkpoint.filenamePattern.c_str());
+	}
+}
+commandCheckpoint;
+
 
 struct CommandDumpName : public Command
 {
@@ -296,8 +332,12 @@ struct CommandPolarizability : public Command
 {
     CommandPolarizability() : Command("polarizability", "jdftx/Output")
 	{
-		format = "<eigenBasis>=" + polarizabilityMap.optionList() + " [<Ecut>=0] [<nEigs>=0]";
-		comments = "Output polarizability matrix in specified eigenBasis";
+		format = "<eigenBasis>=" + polarizabilityMap.optionList() + " [<Ecut>=0] [<nEigs>=0] [<blockMemory>=1024]";
+		comments = "Output polarizability matrix in specified eigenBasis.\n"
+			"\n"
+			"In the plane-wave basis, pair densities are formed and accumulated into the\n"
+			"polarizability matrix in blocks of band pairs. Each block, including the\n"
+			"real-space unoccupied wavefunctions cached for it, is limited to <blockMemory> in MB.";
 		
 		forbid("electron-scattering"); //both are major operations that are given permission to destroy Everything if necessary
 	}
@@ -307,12 +347,14 @@ struct CommandPolarizability : public Command
 		pl.get(e.dump.polarizability->eigenBasis, Polarizability::NonInteracting, polarizabilityMap, "eigenBasis");
 		pl.get(e.dump.polarizability->Ecut, 0., "Ecut");
 		pl.get(e.dump.polarizability->nEigs, 0, "nEigs");
+		pl.get(e.dump.polarizability->blockMemory, 1024., "blockMemory");
+		if(e.dump.polarizability->blockMemory <= 0.) throw string("<blockMemory> must be positive");
 		e.dump.insert(std::make_pair(DumpFreq_End, DumpPolarizability));
 	}
 
 	void printStatus(Everything& e, int iRep)
-	{	logPrintf("%s %lg %d", polarizabilityMap.getString(e.dump.polarizability->eigenBasis),
-			e.dump.polarizability->Ecut, e.dump.polarizability->nEigs);
+	{	logPrintf("%s %lg %d %lg", polarizabilityMap.getString(e.dump.polarizability->eigenBasis),
+			e.dump.polarizability->Ecut, e.dump.polarizability->nEigs, e.dump.polarizability->blockMemory);
 	}
 }
 commandPolarizability;
@@ -325,6 +367,7 @@ enum ElectronScatteringMember
 	ESM_omegaMax,
 	ESM_slabResponse,
 	ESM_EcutTransverse,
+	ESM_cacheMemory,
 	ESM_delim
 };
 EnumStringMap<ElectronScatteringMember> esmMap
@@ -333,7 +376,8 @@ EnumStringMap<ElectronScatteringMember> esmMap
 	ESM_fCut, "fCut",
 	ESM_omegaMax, "omegaMax",
 	ESM_slabResponse, "slabResponse",
-	ESM_EcutTransverse, "EcutTransverse"
+	ESM_EcutTransverse, "EcutTransverse",
+	ESM_cacheMemory, "cacheMemory"
 );
 
 struct CommandElectronScattering : public Command
@@ -366,7 +410,11 @@ struct CommandElectronScattering : public Command
 			"\n+ EcutTransverse <EcutTransverse>\n\n"
 			"   <EcutTransverse> in Eh specifies energy cut-off for dielectric matrix in.\n"
 			"   directions trasverse to the slab normal; only valid when slabResponse = yes.\n"
-			"   (If zero, use the same value as Ecut above.)";
+			"   (If zero, use the same value as Ecut above.)\n"
+			"\n+ cacheMemory <MB>\n\n"
+			"   Memory in MB per process for retaining real-space wavefunctions\n"
+			"   between k-point pairs, which avoids repeating their Fourier transforms\n"
+			"   for each momentum transfer (default: 1024).";
 		
 		require("coulomb-interaction");
 		forbid("polarizability"); //both are major operations that are given permission to destroy Everything if necessary
@@ -386,6 +434,7 @@ struct CommandElectronScattering : public Command
 				case ESM_omegaMax: pl.get(es.omegaMax, 0., "omegaMax", true); break;
 				case ESM_slabResponse: pl.get(es.slabResponse, false, boolMap, "slabResponse", true); break;
 				case ESM_EcutTransverse: pl.get(es.EcutTransverse, 0., "EcutTransverse", true); break;
+				case ESM_cacheMemory: pl.get(es.cacheMemory, 1024., "cacheMemory", true); break;
 				case ESM_delim: return; //end of input
 			}
 		}
@@ -406,6 +455,7 @@ struct CommandElectronScattering : public Command
 		logPrintf(" \\\n\tomegaMax %lg", es.omegaMax);
 		logPrintf(" \\\n\tslabResponse %s", boolMap.getString(es.slabResponse));
 		if(es.slabResponse) logPrintf(" \\\n\tEcutTransverse %lg", es.EcutTransverse);
+		logPrintf(" \\\n\tcacheMemory %lg", es.cacheMemory);
 	}
 }
 commandElectronScattering;
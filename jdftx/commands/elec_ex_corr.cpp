@@ -322,3 +322,32 @@ struct CommandExchangeParameters : public Command
 	}
 }
 commandExchangeParameters;
+
+struct CommandExchangeAce : public Command
+{
+	CommandExchangeAce() : Command("exchange-ace", "jdftx/Electronic/Functional")
+	{
+		format = "yes|no [<nOuterMax>=20]";
+		comments =
+			"Whether to use the adaptively compressed exchange (ACE) operator\n"
+			"for hybrid functionals (default no). The full exact-exchange operator\n"
+			"is evaluated once per update and compressed to a low-rank projector,\n"
+			"which is then applied cheaply within the band solvers (SCF) and the\n"
+			"total energy minimizer. For the latter, the ACE operator is held fixed\n"
+			"during each electronic minimization and updated in an outer loop until\n"
+			"the exact exchange energy changes by less than the electronic energy\n"
+			"threshold, or <nOuterMax> outer iterations are completed.\n"
+			"With no (default), the full exchange operator is recomputed at every energy evaluation.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.exxACE, false, boolMap, "useACE", true);
+		pl.get(e.cntrl.exxACEnOuter, 20, "nOuterMax");
+		if(e.cntrl.exxACEnOuter < 1) throw string("<nOuterMax> must be >= 1");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s %d", boolMap.getString(e.cntrl.exxACE), e.cntrl.exxACEnOuter);
+	}
+}
+commandExchangeAce;
@@ -120,6 +120,71 @@ struct CommandDavidsonBandRatio : public Command
 }
 commandDavidsonBandRatio;
 
+
+struct CommandDavidsonBlockSize : public Command
+{
+	CommandDavidsonBlockSize() : Command("davidson-block-size", "jdftx/Electronic/Optimization")
+	{
+		format = "<blockSize>";
+		comments =
+			"Expand the Davidson subspace using residuals of only the lowest <blockSize>\n"
+			"unconverged bands in each iteration, instead of all bands. Bands that converge\n"
+			"contiguously from the bottom are locked out of the working set, and the subspace\n"
+			"is allowed to grow by 2 <blockSize> bands beyond the working set (see davidson-band-ratio)\n"
+			"before compressing back to it. This reduces the number of Hamiltonian applications\n"
+			"for band-structure calculations with many bands. Convergence is reached when all bands\n"
+			"are locked, and the iteration limit is scaled by the number of blocks per set of bands.\n"
+			"\n"
+			"Default: 0, which expands with all bands and converges on the band energy difference.";
+		hasDefault = false;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.davidsonBlockSize, 0, "blockSize", true);
+		if(e.cntrl.davidsonBlockSize < 0)
+			throw string("<blockSize> must be non-negative");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d", e.cntrl.davidsonBlockSize);
+	}
+}
+commandDavidsonBlockSize;
+
+
+struct CommandBandMinimizeThreads : public Command
+{
+	CommandBandMinimizeThreads() : Command("band-minimize-threads", "jdftx/Electronic/Optimization")
+	{
+		format = "<nThreads>";
+		comments =
+			"Number of quantum numbers (k-points and spins) whose eigenproblems are solved\n"
+			"concurrently in fixed-Hamiltonian minimizations (band structures, the inner\n"
+			"eigensolver of SCF, and converging empty states).\n"
+			"Each of <nThreads> threads (at most the number of cores of each process) solves\n"
+			"one quantum number at a time with unthreaded operators, starting with the\n"
+			"largest bases. The iteration log of each solve is printed once it completes.\n"
+			"This is more efficient than threading each solve over all cores for small unit\n"
+			"cells with many k-points. Set to 1 to solve one at a time on all cores.\n"
+			"The default 0 solves concurrently on all cores only in band structure\n"
+			"calculations (fix-electron-density or fix-electron-potential) with at least as\n"
+			"many quantum numbers per process as cores, and one at a time otherwise.\n"
+			"Concurrent solves are never used on GPUs.";
+		hasDefault = false;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.bandMinimizeThreads, 0, "nThreads", true);
+		if(e.cntrl.bandMinimizeThreads < 0)
+			throw string("<nThreads> must be non-negative");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d", e.cntrl.bandMinimizeThreads);
+	}
+}
+commandBandMinimizeThreads;
+
 //-------------------------------------------------------------------------------------------------
 
 struct CommandLcaoParams : public Command
@@ -300,6 +365,40 @@ commandCacheProjectors;
 
 //-------------------------------------------------------------------------------------------------
 
+struct CommandNonlocalRealspace : public Command
+{
+	CommandNonlocalRealspace() : Command("nonlocal-realspace", "jdftx/Miscellaneous")
+	{
+		format = "yes|no [<tol>=1e-6]";
+		comments =
+			"Apply nonlocal-pseudopotential projectors in real space (no by default).\n"
+			"The projectors of each atom are truncated to the sphere of grid points that\n"
+			"contains all but a fraction <tol> of their norm, so that the projection cost\n"
+			"and projector memory scale with the number of atoms rather than with the\n"
+			"number of atoms times the number of plane waves. This is advantageous for\n"
+			"large supercells; smaller <tol> improves accuracy at increased cost.\n"
+			"Only the electronic Hamiltonian uses the truncated projectors; forces and\n"
+			"spinorial calculations continue to use the exact reciprocal-space projectors.\n"
+			"Species with ultrasoft augmentation or DFT+U corrections also keep their\n"
+			"reciprocal-space projectors cached (if cache-projectors is enabled), since\n"
+			"the overlap and occupation matrices need them at every electronic step.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.realSpaceProjectors, false, boolMap, "useRealSpace", true);
+		pl.get(e.cntrl.realSpaceProjectorTol, 1e-6, "tol");
+		if(e.cntrl.realSpaceProjectorTol<=0. || e.cntrl.realSpaceProjectorTol>=1.)
+			throw string("<tol> must be in (0,1)");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s %lg", boolMap.getString(e.cntrl.realSpaceProjectors), e.cntrl.realSpaceProjectorTol);
+	}
+}
+commandNonlocalRealspace;
+
+//-------------------------------------------------------------------------------------------------
+
 struct CommandBasis : public Command
 {
 	CommandBasis() : Command("basis", "jdftx/Electronic/Parameters")
@@ -162,6 +162,36 @@ struct CommandFluidInitialState : public Command
 commandFluidInitialState;
 
 
+struct CommandFluidStateExtrapolation : public Command
+{
+	CommandFluidStateExtrapolation() : Command("fluid-state-extrapolation", "jdftx/Fluid/Optimization")
+	{
+		format = "<nHistory>";
+		comments =
+			"Extrapolate the initial fluid state for each ionic step from the converged fluid states\n"
+			"at up to <nHistory> previous ionic configurations, using coefficients that best reproduce\n"
+			"the current atomic positions from the previous ones (<nHistory> = 2 amounts to linear\n"
+			"extrapolation along the atomic displacements). This reduces fluid iterations during\n"
+			"geometry optimization and dynamics, at the cost of storing <nHistory> fluid states.\n"
+			"Default: 0 (disabled), which starts each fluid solve from the previous state.";
+		hasDefault = true;
+		
+		require("fluid");
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	int& nStateHistory = e.eVars.fluidParams.nStateHistory;
+		pl.get(nStateHistory, 0, "nHistory");
+		if(nStateHistory < 0) throw string("<nHistory> must be non-negative");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d", e.eVars.fluidParams.nStateHistory);
+	}
+}
+commandFluidStateExtrapolation;
+
+
 struct CommandFluidVdwScale : public Command
 {
 	CommandFluidVdwScale() : Command("fluid-vdwScale", "jdftx/Fluid/Parameters")
@@ -218,6 +218,36 @@ struct CommandPcmNonlinearDebug : public Command
 commandPcmNonlinearDebug;
 
 
+EnumStringMap<bool> pcmPreconditionerMap(false, "bulk", true, "cavity");
+
+struct CommandPcmPreconditioner : public Command
+{
+	CommandPcmPreconditioner() : Command("pcm-preconditioner", "jdftx/Fluid/Optimization")
+	{
+		format = "<type>=" + pcmPreconditionerMap.optionList();
+		comments =
+			"Select the preconditioner for the inner iterations of PCM fluids, where <type> is one of:\n"
+			"\n+ bulk: use the response of the homogeneous bulk fluid (default)\n"
+			"\n+ cavity: blend the inverse responses of the bulk fluid and of vacuum by the cavity shape function,\n"
+			"   and scale out the cavity-dependent local response in the NonlinearPCM minimizer.\n"
+			"   This typically reduces fluid iterations for high-dielectric, high-ionic-strength\n"
+			"   electrolytes near charged surfaces, at a slightly higher cost per iteration.\n"
+			"\n"
+			"Applies to LinearPCM, SaLSA and NonlinearPCM (both the minimizer and the inner solve of pcm-nonlinear-scf).";
+		hasDefault = true;
+	}
+	
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.eVars.fluidParams.cavityPreconditioner, false, pcmPreconditionerMap, "type");
+	}
+	
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", pcmPreconditionerMap.getString(e.eVars.fluidParams.cavityPreconditioner));
+	}
+}
+commandPcmPreconditioner;
+
+
 
 struct CommandIonWidth : public Command
 {
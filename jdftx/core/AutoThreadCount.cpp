@@ -39,21 +39,27 @@ int getPhysicalCores()
 }
 
 int nProcsAvailable = getPhysicalCores();
-bool threadOperators = true;
+static std::atomic<int> suspendDepth(0); //number of enclosing parallel sections (operators use all processors only outside these)
+
+int operatorThreadCount()
+{	return suspendDepth ? 1 : nProcsAvailable;
+}
 
 bool shouldThreadOperators()
-{	return threadOperators;
+{	return operatorThreadCount() > 1;
 }
 
 void suspendOperatorThreading()
-{	threadOperators = false;
+{	if(suspendDepth++) return; //already suspended (nested or concurrent parallel sections)
 	#if defined(MKL_PROVIDES_BLAS) || defined(MKL_PROVIDES_FFT)
 	mkl_set_num_threads(1);
 	#endif
 }
 
 void resumeOperatorThreading()
-{	threadOperators = true;
+{	int depth = suspendDepth;
+	while(depth>0 && !suspendDepth.compare_exchange_weak(depth, depth-1)); //decrement, but not below zero
+	if(depth>1) return; //still within an enclosing parallel section
 	#if defined(MKL_PROVIDES_BLAS) || defined(MKL_PROVIDES_FFT)
 	mkl_set_num_threads(nProcsAvailable);
 	mkl_disable_fast_mm();
@@ -94,7 +100,8 @@ AutoThreadCount::~AutoThreadCount()
 }
 
 int AutoThreadCount::getThreadCount()
-{	if(!shouldThreadOperators()) return 1;
+{	int nAvailable = operatorThreadCount();
+	if(nAvailable < nProcsAvailable) return nAvailable; //within a parallel section
 	if(settled) return nOpt; //optimum value has been found and previously stored
 	for(int i=minThreads-1; i<nMax; i++)
 	{	if(count[i]<minStats) return i+1; //not enough stats for this #threads yet, so get it!
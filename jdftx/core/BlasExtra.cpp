@@ -63,7 +63,7 @@ void eblas_zgemm(
 	const CBLAS_TRANSPOSE TransA, const CBLAS_TRANSPOSE TransB, const int M, const int N, const int K,
 	const complex& alpha, const complex *A, const int lda, const complex *B, const int ldb,
 	const complex& beta, complex *C, const int ldc)
-{
+{	profileCounts(8.*M*N*K, 16.*(double(M)*K + double(K)*N + 2.*M*N));
 	#ifdef THREADED_BLAS
 	cblas_zgemm(CblasColMajor, TransA, TransB, M, N, K, &alpha, A, lda, B, ldb, &beta, C, ldc);
 	#else
@@ -53,6 +53,14 @@ struct CoulombParams
 	
 	vector3<> Efield; //!< electric field (in Cartesian coordinates, atomic units [Eh/e/a0])
 	
+	//! Method for the reciprocal-space part of the ionic Ewald sum (3D periodic geometry)
+	enum EwaldMethod
+	{	EwaldAuto, //!< choose based on estimated cost for the number of atoms (default)
+		EwaldDirect, //!< explicit sum over reciprocal lattice vectors
+		EwaldParticleMesh //!< smooth particle-mesh Ewald on the fftbox
+	};
+	EwaldMethod ewaldMethod; //!< method for reciprocal-space Ewald sum
+	
 	//Parameters for computing exchange integrals:
 	//! Regularization method for G=0 singularities in exchange
 	enum ExchangeRegularization
@@ -21,40 +21,129 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Coulomb_internal.h>
 #include <core/CoulombKernel.h>
 #include <core/BlasExtra.h>
+#include <core/NeighborList.h>
+#include <core/Operators.h>
+
+//Cardinal B-spline weights M[j] = M_p(w+j) and their derivatives M_w[j] for j = 0 to p-1, where 0 <= w < 1
+template<int p> void pmeBspline(double w, double* M, double* M_w)
+{	double a[p]; a[0] = 1.; for(int j=1; j<p; j++) a[j] = 0.; //order 1
+	for(int n=2; n<=p; n++)
+	{	if(n==p) //derivative of order p from order p-1
+		{	M_w[0] = a[0];
+			for(int j=1; j<p; j++) M_w[j] = a[j] - a[j-1];
+		}
+		for(int j=n-1; j>0; j--)
+			a[j] = ((w+j)*a[j] + (n-w-j)*a[j-1]) / (n-1);
+		a[0] *= w / (n-1);
+	}
+	for(int j=0; j<p; j++) M[j] = a[j];
+}
+
+//B-spline weights for each atom along each direction (the charge of an atom with u = S[k]*pos[k] spreads to grid points floor(u)-j with weights M_p(u-floor(u)+j))
+template<int p> void pmeBspline_thread(size_t iStart, size_t iStop, const std::vector<Atom>* atoms, const vector3<int> S, vector3<int>* iBase, double* M, double* M_x)
+{	for(size_t i=iStart; i<iStop; i++)
+		for(int k=0; k<3; k++)
+		{	double u = S[k] * atoms->at(i).pos[k], uFloor = floor(u);
+			iBase[i][k] = int(uFloor);
+			size_t offs = p*(3*i+k);
+			pmeBspline<p>(u-uFloor, M+offs, M_x+offs);
+			for(int j=0; j<p; j++) M_x[offs+j] *= S[k]; //convert to derivative w.r.t lattice coordinate
+		}
+}
+
+//Forces from mesh potential phi for each atom (contravariant lattice coordinates)
+template<int p> void pmeForces_thread(size_t iStart, size_t iStop, std::vector<Atom>* atoms, const vector3<int> S,
+	const vector3<int>* iBase, const double* M, const double* M_x, const double* phi)
+{	for(size_t i=iStart; i<iStop; i++)
+	{	Atom& a = atoms->at(i);
+		const double *M0=M+p*(3*i), *M1=M0+p, *M2=M1+p;
+		const double *M0_x=M_x+p*(3*i), *M1_x=M0_x+p, *M2_x=M1_x+p;
+		vector3<> E_x;
+		for(int j0=0; j0<p; j0++)
+		{	int i0 = positiveRemainder(iBase[i][0]-j0, S[0]);
+			for(int j1=0; j1<p; j1++)
+			{	int i1 = positiveRemainder(iBase[i][1]-j1, S[1]);
+				const double* phiRow = phi + S[2]*size_t(i1 + S[1]*i0);
+				for(int j2=0; j2<p; j2++)
+				{	double phiCur = phiRow[positiveRemainder(iBase[i][2]-j2, S[2])];
+					E_x[0] += phiCur * M0_x[j0] * M1[j1] * M2[j2];
+					E_x[1] += phiCur * M0[j0] * M1_x[j1] * M2[j2];
+					E_x[2] += phiCur * M0[j0] * M1[j1] * M2_x[j2];
+				}
+			}
+		}
+		a.force -= a.Z * E_x;
+	}
+}
+
+//Reciprocal-space Ewald kernel on the fftbox, including the B-spline interpolation correction bSq along each direction
+void pmeKernel_thread(size_t iStart, size_t iStop, const vector3<int> S, const matrix3<> GGT, double sigma, double detR,
+	const double* bSq0, const double* bSq1, const double* bSq2, double* kernel)
+{	THREAD_halfGspaceLoop
+	(	double Gsq = GGT.metric_length_squared(iG);
+		kernel[i] = Gsq
+			? (4*M_PI * exp(-0.5*sigma*sigma*Gsq)/(Gsq * detR))
+				* bSq0[positiveRemainder(iG[0],S[0])] * bSq1[positiveRemainder(iG[1],S[1])] * bSq2[positiveRemainder(iG[2],S[2])]
+			: 0.;
+	)
+}
 
 //! Standard 3D Ewald sum
 class EwaldPeriodic : public Ewald
 {
+	static const int pmeOrder = 10; //!< B-spline interpolation order for particle-mesh Ewald
 	matrix3<> R, G, RTR, GGT; //!< Lattice vectors, reciprocal lattice vectors and corresponding metrics
+	const GridInfo* gInfoMesh; //!< fftbox for particle-mesh Ewald (null for direct reciprocal-space sum)
 	double sigma; //!< gaussian width for Ewald sums
-	vector3<int> Nreal; //!< max unit cell indices for real-space sum
+	vector3<int> Nreal; //!< max unit cell indices for direct real-space sum
+	mutable NeighborList neighborList; //!< cell list for real-space sum with particle-mesh Ewald
 	vector3<int> Nrecip; //!< max unit cell indices for reciprocal-space sum
+	std::shared_ptr<RealKernel> meshKernel; //!< reciprocal-space kernel for particle-mesh Ewald
 
 public:
-	EwaldPeriodic(const matrix3<>& R, int nAtoms)
-	: R(R), G((2*M_PI)*inv(R)), RTR((~R)*R), GGT(G*(~G))
+	EwaldPeriodic(const matrix3<>& R, int nAtoms, const GridInfo* gInfoMesh, CoulombParams::EwaldMethod method)
+	: R(R), G((2*M_PI)*inv(R)), RTR((~R)*R), GGT(G*(~G)),
+		gInfoMesh(selectMesh(R, G, nAtoms, gInfoMesh, method)),
+		sigma(this->gInfoMesh ? meshSigma(*(this->gInfoMesh)) : optimumSigma(R, G, nAtoms)),
+		neighborList(CoulombKernel::nSigmasPerWidth * sigma)
 	{	logPrintf("\n---------- Setting up ewald sum ----------\n");
-		//Determine optimum gaussian width for Ewald sums:
-		// From below, the number of reciprocal cells ~ Prod_k |R.column[k]|
-		//    and number of real space cells ~ Prod_k |G.row[k]|
-		// including the fact that the real space cost ~ Natoms^2/cell
-		//    and the reciprocal space cost ~ Natoms/cell
-		sigma = 1.;
-		for(int k=0; k<3; k++)
-			sigma *= R.column(k).length() / G.row(k).length();
-		sigma = pow(sigma/std::max(1,nAtoms), 1./6);
-		logPrintf("Optimum gaussian width for ewald sums = %lf bohr.\n", sigma);
+		logPrintf("%s gaussian width for ewald sums = %lf bohr.\n", this->gInfoMesh ? "Fftbox-resolved" : "Optimum", sigma);
 		
 		//Carry real space sums to Rmax = 10 sigma and Gmax = 10/sigma
 		//This leads to relative errors ~ 1e-22 in both sums, well within double precision limits
-		for(int k=0; k<3; k++)
-		{	Nreal[k] = 1+ceil(CoulombKernel::nSigmasPerWidth * G.row(k).length() * sigma / (2*M_PI));
-			Nrecip[k] = 1+ceil(CoulombKernel::nSigmasPerWidth * R.column(k).length() / (2*M_PI*sigma));
+		Nreal = getNreal(G, sigma);
+		Nrecip = getNrecip(R, sigma);
+		if(this->gInfoMesh)
+		{	//The narrow gaussian makes the real-space cutoff smaller than the unit cell for large cells,
+			//where a cell list avoids visiting all pairs of atoms in all Nreal cells:
+			logPrintf("Real space sum over pairs within %lg bohr (using cell lists).\n", CoulombKernel::nSigmasPerWidth * sigma);
+			const vector3<int>& S = this->gInfoMesh->S;
+			logPrintf("Reciprocal space sum using particle-mesh Ewald of order %d on fftbox of size ", pmeOrder);
+			S.print(globalLog, " %d ");
+			//B-spline interpolation correction (inverse squared magnitude of Euler exponential spline factors):
+			double M[pmeOrder], M_w[pmeOrder];
+			pmeBspline<pmeOrder>(0., M, M_w); //B-spline at integer arguments
+			std::vector<double> bSq[3];
+			for(int k=0; k<3; k++)
+			{	bSq[k].resize(S[k]);
+				for(int m=0; m<S[k]; m++)
+				{	complex den = 0.;
+					for(int j=1; j<pmeOrder; j++)
+						den += M[j] * cis((2*M_PI*m*(j-1))/S[k]);
+					bSq[k][m] = 1./den.norm();
+				}
+			}
+			meshKernel = std::make_shared<RealKernel>(*(this->gInfoMesh));
+			threadLaunch(pmeKernel_thread, this->gInfoMesh->nG, S, GGT, sigma, fabs(det(R)),
+				bSq[0].data(), bSq[1].data(), bSq[2].data(), meshKernel->data());
+			zeroNyquist(*meshKernel);
+		}
+		else
+		{	logPrintf("Real space sum over %d unit cells with max indices ", (2*Nreal[0]+1)*(2*Nreal[1]+1)*(2*Nreal[2]+1));
+			Nreal.print(globalLog, " %d ");
+			logPrintf("Reciprocal space sum over %d terms with max indices ", (2*Nrecip[0]+1)*(2*Nrecip[1]+1)*(2*Nrecip[2]+1));
+			Nrecip.print(globalLog, " %d ");
 		}
-		logPrintf("Real space sum over %d unit cells with max indices ", (2*Nreal[0]+1)*(2*Nreal[1]+1)*(2*Nreal[2]+1));
-		Nreal.print(globalLog, " %d ");
-		logPrintf("Reciprocal space sum over %d terms with max indices ", (2*Nrecip[0]+1)*(2*Nrecip[1]+1)*(2*Nrecip[2]+1));
-		Nrecip.print(globalLog, " %d ");
 	}
 
 	double energyAndGrad(std::vector<Atom>& atoms) const
@@ -74,6 +163,22 @@ public:
 		for(Atom& a: atoms)
 			for(int k=0; k<3; k++)
 				a.pos[k] -= floor(0.5 + a.pos[k]);
+		//Real space sum and reciprocal space sum using particle-mesh Ewald:
+		if(gInfoMesh)
+		{	std::vector< vector3<> > pos(atoms.size());
+			for(size_t i=0; i<atoms.size(); i++) pos[i] = atoms[i].pos;
+			neighborList.update(R, pos);
+			E += neighborList.pairSum(pos, [&](int i1, int i2, vector3<> x, double rSq)
+			{	Atom& a1 = atoms[i1];
+				const Atom& a2 = atoms[i2];
+				double r = sqrt(rSq);
+				a1.force += (RTR * x) *
+					(a1.Z * a2.Z * (erfc(eta*r)/r + (2./sqrt(M_PI))*eta*exp(-etaSq*rSq))/rSq);
+				return 0.5 * a1.Z * a2.Z * erfc(eta*r)/r;
+			});
+			E += meshEnergyAndGrad(atoms);
+			return E;
+		}
 		//Real space sum:
 		vector3<int> iR; //integer cell number
 		for(const Atom& a2: atoms)
@@ -109,6 +214,95 @@ public:
 				}
 		return E;
 	}
+
+private:
+	//! Optimum gaussian width balancing real and reciprocal space costs
+	static double optimumSigma(const matrix3<>& R, const matrix3<>& G, int nAtoms)
+	{	// The number of reciprocal cells ~ Prod_k |R.column[k]|
+		//    and number of real space cells ~ Prod_k |G.row[k]|
+		// including the fact that the real space cost ~ Natoms^2/cell
+		//    and the reciprocal space cost ~ Natoms/cell
+		double sigma = 1.;
+		for(int k=0; k<3; k++)
+			sigma *= R.column(k).length() / G.row(k).length();
+		return pow(sigma/std::max(1,nAtoms), 1./6);
+	}
+	
+	//! Smallest gaussian width for which particle-mesh Ewald (at pmeOrder) on the fftbox
+	//! has relative errors ~ 1e-10 in energies and forces (the real-space cost is minimized)
+	static double meshSigma(const GridInfo& gInfo)
+	{	double hMax = std::max(gInfo.h[0].length(), std::max(gInfo.h[1].length(), gInfo.h[2].length()));
+		return 4. * hMax;
+	}
+	
+	//! Max unit cell indices for direct real-space sum with gaussian width sigma
+	static vector3<int> getNreal(const matrix3<>& G, double sigma)
+	{	vector3<int> Nreal;
+		for(int k=0; k<3; k++)
+			Nreal[k] = 1+ceil(CoulombKernel::nSigmasPerWidth * G.row(k).length() * sigma / (2*M_PI));
+		return Nreal;
+	}
+	
+	//! Max unit cell indices for direct reciprocal-space sum with gaussian width sigma
+	static vector3<int> getNrecip(const matrix3<>& R, double sigma)
+	{	vector3<int> Nrecip;
+		for(int k=0; k<3; k++)
+			Nrecip[k] = 1+ceil(CoulombKernel::nSigmasPerWidth * R.column(k).length() / (2*M_PI*sigma));
+		return Nrecip;
+	}
+	
+	//! Return the mesh if particle-mesh Ewald is requested, or is estimated to be cheaper when method = EwaldAuto, and null otherwise
+	static const GridInfo* selectMesh(const matrix3<>& R, const matrix3<>& G, int nAtoms, const GridInfo* gInfoMesh, CoulombParams::EwaldMethod method)
+	{	if(!gInfoMesh || method==CoulombParams::EwaldDirect) return 0;
+		if(method==CoulombParams::EwaldParticleMesh) return gInfoMesh;
+		//Estimate operation counts of the two methods (real-space pairs + reciprocal-space terms):
+		double sigmaDirect = optimumSigma(R, G, nAtoms);
+		vector3<int> NrealDirect = getNreal(G, sigmaDirect);
+		vector3<int> NrecipDirect = getNrecip(R, sigmaDirect);
+		double costDirect = double(nAtoms) * nAtoms * (2*NrealDirect[0]+1)*(2*NrealDirect[1]+1)*(2*NrealDirect[2]+1)
+			+ 2. * nAtoms * (2*NrecipDirect[0]+1)*(2*NrecipDirect[1]+1)*(2*NrecipDirect[2]+1);
+		double nr = gInfoMesh->nr;
+		double nPairsPerSigmaCubed = nAtoms * nAtoms * (4*M_PI/3) * pow(CoulombKernel::nSigmasPerWidth, 3) / fabs(det(R));
+		double costMesh = nPairsPerSigmaCubed * pow(meshSigma(*gInfoMesh), 3)
+			+ 2. * nAtoms * pow(pmeOrder, 3) + 10. * nr * log2(nr);
+		return (costMesh < costDirect) ? gInfoMesh : 0;
+	}
+	
+	//! Reciprocal-space energy and forces using smooth particle-mesh Ewald
+	double meshEnergyAndGrad(std::vector<Atom>& atoms) const
+	{	static StopWatch watch("EwaldPeriodic::mesh"); watch.start();
+		const GridInfo& gInfo = *gInfoMesh;
+		const vector3<int>& S = gInfo.S;
+		const int p = pmeOrder;
+		size_t nAtoms = atoms.size();
+		//B-spline weights:
+		std::vector< vector3<int> > iBase(nAtoms);
+		std::vector<double> M(p*3*nAtoms), M_x(p*3*nAtoms);
+		threadLaunch(pmeBspline_thread<p>, nAtoms, &atoms, S, iBase.data(), M.data(), M_x.data());
+		//Spread charges to mesh:
+		ScalarField Q; nullToZero(Q, gInfo);
+		double* Qdata = Q->data();
+		for(size_t i=0; i<nAtoms; i++)
+		{	const double *M0=M.data()+p*(3*i), *M1=M0+p, *M2=M1+p;
+			for(int j0=0; j0<p; j0++)
+			{	int i0 = positiveRemainder(iBase[i][0]-j0, S[0]);
+				for(int j1=0; j1<p; j1++)
+				{	int i1 = positiveRemainder(iBase[i][1]-j1, S[1]);
+					double* Qrow = Qdata + S[2]*size_t(i1 + S[1]*i0);
+					double ZM01 = atoms[i].Z * M0[j0] * M1[j1];
+					for(int j2=0; j2<p; j2++)
+						Qrow[positiveRemainder(iBase[i][2]-j2, S[2])] += ZM01 * M2[j2];
+				}
+			}
+		}
+		//Mesh potential and energy:
+		ScalarField phi = I((*meshKernel) * Idag(Q));
+		double E = 0.5 * dot(Q, phi);
+		//Forces:
+		threadLaunch(pmeForces_thread<p>, nAtoms, &atoms, S, iBase.data(), M.data(), M_x.data(), phi->data());
+		watch.stop();
+		return E;
+	}
 };
 
 
@@ -126,5 +320,7 @@ ScalarFieldTilde CoulombPeriodic::apply(ScalarFieldTilde&& in) const
 }
 
 std::shared_ptr<Ewald> CoulombPeriodic::createEwald(matrix3<> R, size_t nAtoms) const
-{	return std::make_shared<EwaldPeriodic>(R, nAtoms);
+{	//Particle-mesh Ewald can use the fftbox only for the unit cell (not for k-point supercells):
+	const GridInfo* gInfoMesh = (R == gInfo.R) ? &gInfo : 0;
+	return std::make_shared<EwaldPeriodic>(R, nAtoms, gInfoMesh, params.ewaldMethod);
 }
@@ -29,6 +29,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 const double GridInfo::maxAllowedStrain = 0.35;
+const int GridInfo::nFFTbatch;
 
 GridInfo::GridInfo():Gmax(0),GmaxRho(0),nr(0),initialized(false)
 {
@@ -291,9 +292,10 @@ fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
 	fftw_init_threads();
 	fftw_plan_with_nthreads(nThreads);
 	//--- temp data for planning:
-	bool inPlace = (planType==PlanForwardInPlace) || (planType==PlanInverseInPlace);
+	bool batched = (planType==PlanForwardBatch) || (planType==PlanInverseBatch);
+	bool inPlace = (planType==PlanForwardInPlace) || (planType==PlanInverseInPlace) || batched;
 	ManagedArray<fftw_complex> testMem, testMem2;
-	testMem.init(nr);
+	testMem.init(batched ? nFFTbatch*nr : nr);
 	fftw_complex* testData = testMem.data();
 	fftw_complex* testData2 = 0;
 	if(!inPlace)
@@ -310,6 +312,12 @@ fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
 		case PlanForwardInPlace: plan = fftw_plan_dft_3d(S[0], S[1], S[2], testData, testData, FFTW_FORWARD, PLANNER_FLAGS); break;
 		case PlanRtoC:           plan = fftw_plan_dft_r2c_3d(S[0], S[1], S[2], (double*)testData, testData2, PLANNER_FLAGS); break;
 		case PlanCtoR:           plan = fftw_plan_dft_c2r_3d(S[0], S[1], S[2], testData, (double*)testData2, PLANNER_FLAGS); break;
+		case PlanForwardBatch:
+		case PlanInverseBatch:
+		{	int sign = (planType==PlanForwardBatch) ? FFTW_FORWARD : FFTW_BACKWARD;
+			plan = fftw_plan_many_dft(3, &S[0], nFFTbatch, testData, 0, 1, nr, testData, 0, 1, nr, sign, PLANNER_FLAGS);
+			break;
+		}
 	}
 	if(!plan) die("Failed to create FFT plan with %d threads",  nThreads);
 	//--- cache and return plan:
@@ -317,3 +325,9 @@ fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
 	planLock.unlock();
 	return plan;
 }
+
+void GridInfo::profileFFT(int nTransforms, bool realTransform) const
+{	if(!StopWatch::profilingEnabled) return;
+	double nrEff = realTransform ? 0.5*nr : nr;
+	profileCounts(nTransforms * 5.*nrEff*log2(double(nr)), nTransforms * 2.*nrEff*sizeof(complex));
+}
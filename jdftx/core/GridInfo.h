@@ -117,8 +117,14 @@ public:
 		PlanInverseInPlace, //!< Inverse in-place complex transform
 		PlanRtoC, //!< Real to complex transform
 		PlanCtoR, //!< Complex to real transform
+		PlanForwardBatch, //!< Forward in-place complex transform of nFFTbatch contiguous arrays
+		PlanInverseBatch, //!< Inverse in-place complex transform of nFFTbatch contiguous arrays
 	};
+	static const int nFFTbatch = 4; //!< number of transforms performed together by the batched plans
 	fftw_plan getPlan(PlanType planType, int nThreads) const; //get an FFTW plan of specified type with specified thread count
+	
+	//! Record operation and memory-traffic counts of nTransforms FFTs on this grid with the profiler (see profileCounts)
+	void profileFFT(int nTransforms=1, bool realTransform=false) const;
 	#ifdef GPU_ENABLED
 	cufftHandle planZ2Z; //!< CUFFT plan for all the complex transforms
 	cufftHandle planD2Z; //!< CUFFT plan for R -> G
@@ -158,6 +158,24 @@ void MPIUtil::allReduce(bool* data, size_t nData, MPIUtil::ReduceOp op, bool saf
 	}
 }
 
+MPIUtil::Request MPIUtil::allReduceAsync(complex* data, size_t nData, MPIUtil::ReduceOp op) const
+{	assert(op!=MPIUtil::ReduceMax && op!=MPIUtil::ReduceMin && op!=MPIUtil::ReduceProd);
+	return allReduceAsync((double*)data, 2*nData, op);
+}
+
+void MPIUtil::wait(MPIUtil::Request& request) const
+{
+	#ifdef MPI_ENABLED
+	MPI_Wait(&request, MPI_STATUS_IGNORE);
+	#endif
+}
+
+void MPIUtil::waitAll(std::vector<MPIUtil::Request>& requests) const
+{
+	#ifdef MPI_ENABLED
+	if(requests.size()) MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+	#endif
+}
 
 //----------------------- File I/O routines -------------------------------
 
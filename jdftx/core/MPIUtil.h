@@ -77,6 +77,17 @@ public:
 	void allReduce(bool* data, size_t nData, ReduceOp op, bool safeMode=false) const;  //!< specialization for bool which is not natively supported by MPI
 	template<typename T> void allReduce(T& data, int& index, ReduceOp op) const; //!< maximum / minimum with index location (MAXLOC / MINLOC modes); use op = ReduceMin or ReduceMax
 	
+	//Non-blocking reduce functions (data must not be accessed until the returned request completes in wait()):
+	#ifdef MPI_ENABLED
+	typedef MPI_Request Request;
+	#else
+	typedef int Request;
+	#endif
+	template<typename T> Request allReduceAsync(T* data, size_t nData, ReduceOp op) const; //!< generic non-blocking array reduction
+	Request allReduceAsync(complex* data, size_t nData, ReduceOp op) const; //!< specialization for complex which is not natively supported by MPI
+	void wait(Request& request) const; //!< wait for completion of a non-blocking operation
+	void waitAll(std::vector<Request>& requests) const; //!< wait for completion of several non-blocking operations
+	
 	//File access (tiny subset of MPI-IO, using byte offsets alone, and made to closely resemble stdio):
 	#ifdef MPI_ENABLED
 	typedef MPI_File File;
@@ -232,5 +243,16 @@ template<typename T> void MPIUtil::allReduce(T& data, int& index, MPIUtil::Reduc
 	#endif
 }
 
+template<typename T> MPIUtil::Request MPIUtil::allReduceAsync(T* data, size_t nData, MPIUtil::ReduceOp op) const
+{	using namespace MPIUtilPrivate;
+	#ifdef MPI_ENABLED
+	Request request = MPI_REQUEST_NULL;
+	if(nProcs>1) MPI_Iallreduce(MPI_IN_PLACE, data, nData, DataType<T>::get(), mpiOp(op), MPI_COMM_WORLD, &request);
+	return request;
+	#else
+	return 0;
+	#endif
+}
+
 //!@endcond
 #endif // JDFTX_CORE_MPIUTIL_H
@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <mutex>
 #include <map>
 #include <set>
+#include <vector>
 
 //-------- Memory usage profiler ---------
 
@@ -35,7 +36,7 @@ namespace MemUsageReport
 	{	
 		#ifdef ENABLE_PROFILING
 		struct Usage
-		{	size_t current, peak; //!< current and peak memory usage (in unit of complex numbers i.e. 16 bytes)
+		{	size_t current, peak; //!< current and peak memory usage (in bytes)
 			Usage() : current(0), peak(0) {}
 			
 			Usage& operator+=(size_t n)
@@ -83,9 +84,11 @@ namespace MemUsageReport
 				break;
 			}
 			case Print:
-			{	for(auto entry: usageMap)
+			{	usageLock.lock();
+				for(auto entry: usageMap)
 					logPrintf("MEMUSAGE: %30s %12.6lf GB\n", entry.first.c_str(), entry.second.peak * bytesToGB);
 				logPrintf("MEMUSAGE: %30s %12.6lf GB\n", "Total", usageTotal.peak * bytesToGB);
+				usageLock.unlock();
 				break;
 			}
 		}
@@ -98,14 +101,39 @@ namespace MemUsageReport
 
 namespace MemPool
 {
+	//Size classes for recycling freed buffers: multiples of 64 bytes up to 4 kB,
+	//and eighths of the leading power of two beyond that (at most 12.5% overhead)
+	inline size_t sizeClass(size_t size)
+	{	if(size <= 4096) return (size + 63) & (~size_t(63));
+		int log2size = 0;
+		while((size >> (log2size+1))) log2size++;
+		const size_t stepMask = (size_t(1) << (log2size-3)) - 1;
+		return (size + stepMask) & (~stepMask);
+	}
+	
 	//Pool memory allocations in a memory space abstracted by MemSpace
 	//MemSpace is a tag class with static functions:
 	// void* alloc(size_t);  //returns 0 when out of memory
 	// void free(void*);     //assumed to not fail
 	// void outOfMemory();   //exit with appropriate out of memory error
+	//Freed buffers are retained (up to memcacheSize bytes, as set when the pool is first used) by size class and recycled for
+	//subsequent allocations of the same size class, bypassing both the pool and the system allocator
 	template<typename MemSpace> class MemPool
 	{	uint8_t* pool; //pointer to entire pool of memory (allocated once)
 		std::mutex lock; //for thread safety
+		//Freed buffers retained for reuse, by size class:
+		std::map<size_t,std::vector<void*>> cache;
+		size_t cacheLimit; //memcacheSize at construction (fixed thereafter, since it changes the sizes allocated)
+		size_t cacheBytes, cachePeak; //current and peak bytes held in cache
+		size_t nCacheHits, nCacheMisses;
+		//Release all cached buffers (call with lock held):
+		inline void flushCache()
+		{	for(auto& entry: cache)
+				for(void* ptr: entry.second)
+					poolFree(ptr);
+			cache.clear();
+			cacheBytes = 0;
+		}
 		//Allocated memory
 		std::map<size_t,size_t> used; //start -> stop
 		//Available 'holes' in memory:
@@ -157,20 +185,17 @@ namespace MemPool
 			//Uncomment following to debug:
 			//logPrintf("Deleted (%lu,%lu)\t", start,start+size); printHoles();
 		}
-	public:
-		MemPool() : pool(0)
-		{	if(mempoolSize)
-			{	pool = (uint8_t*)MemSpace::alloc(mempoolSize);
-				if(!pool) MemSpace::outOfMemory();
-				addHole(0, mempoolSize);
+		//Allocate / free from the pool (or externally if pool not in use / full); call with lock held:
+		void* poolAlloc(size_t sizeRequested)
+		{	if(!mempoolSize)
+			{	void* ptr = MemSpace::alloc(sizeRequested);
+				if(!ptr && cacheBytes)
+				{	flushCache(); //release cached buffers and retry
+					ptr = MemSpace::alloc(sizeRequested);
+				}
+				if(!ptr) MemSpace::outOfMemory();
+				return ptr;
 			}
-		}
-		~MemPool()
-		{	if(pool) MemSpace::free(pool);
-		}
-		void* alloc(size_t sizeRequested)
-		{	if(!mempoolSize) return MemSpace::alloc(sizeRequested); //pool not in use
-			lock.lock();
 			//Find size adjusted to chunk size:
 			const size_t chunkSize = 64; // 4096; //typical page size
 			const size_t chunkMask = chunkSize - 1;
@@ -179,8 +204,11 @@ namespace MemPool
 			MapSetIter ubound = holesBySize.upper_bound(size);
 			if(ubound == holesBySize.end())
 			{	//No hole big enough left, so allocate externally:
-				lock.unlock();
 				void* ptr = MemSpace::alloc(sizeRequested);
+				if(!ptr && cacheBytes)
+				{	flushCache(); //release cached buffers and retry
+					return poolAlloc(sizeRequested);
+				}
 				if(!ptr) MemSpace::outOfMemory();
 				return ptr;
 			}
@@ -191,13 +219,11 @@ namespace MemPool
 				used[start] = start+size; //mark allocated range
 				removeHole(start, 0, &ubound); //remove old hole
 				if(holeSize > size) addHole(start+size, holeSize-size); //add hole left behind (if any)
-				lock.unlock();
 				return (void*)(pool+start);
 			}
 		}
-		void free(void* ptr)
+		void poolFree(void* ptr)
 		{	if(!mempoolSize) return MemSpace::free(ptr); //pool not in use
-			lock.lock();
 			//Find in used map:
 			size_t start = ((uint8_t*)ptr) - pool;
 			MapIter usedIter = used.find(start);
@@ -211,7 +237,57 @@ namespace MemPool
 				used.erase(usedIter); //remove from used
 				addHole(start, size); //add corresponding hole
 			}
-			lock.unlock();
+		}
+	public:
+		MemPool() : pool(0), cacheLimit(memcacheSize), cacheBytes(0), cachePeak(0), nCacheHits(0), nCacheMisses(0)
+		{	if(mempoolSize)
+			{	pool = (uint8_t*)MemSpace::alloc(mempoolSize);
+				if(!pool) MemSpace::outOfMemory();
+				addHole(0, mempoolSize);
+			}
+		}
+		~MemPool()
+		{	if(pool) MemSpace::free(pool);
+		}
+		//Allocate sizeRequested bytes, reusing a cached buffer of the same size class if available
+		void* alloc(size_t sizeRequested)
+		{	size_t size = cacheLimit ? sizeClass(sizeRequested) : sizeRequested;
+			std::lock_guard<std::mutex> guard(lock);
+			if(cacheLimit)
+			{	auto iter = cache.find(size);
+				if(iter != cache.end())
+				{	void* ptr = iter->second.back();
+					iter->second.pop_back();
+					if(!iter->second.size()) cache.erase(iter);
+					cacheBytes -= size;
+					nCacheHits++;
+					return ptr;
+				}
+				nCacheMisses++;
+			}
+			return poolAlloc(size);
+		}
+		//Free a buffer of sizeRequested bytes (same as in corresponding alloc), retaining it for reuse if cache has space
+		void free(void* ptr, size_t sizeRequested)
+		{	std::lock_guard<std::mutex> guard(lock);
+			if(cacheLimit)
+			{	size_t size = sizeClass(sizeRequested);
+				if(cacheBytes + size <= cacheLimit)
+				{	cache[size].push_back(ptr);
+					cacheBytes += size;
+					if(cacheBytes > cachePeak) cachePeak = cacheBytes;
+					return;
+				}
+			}
+			poolFree(ptr);
+		}
+		//Print statistics of buffer reuse
+		void report(const char* spaceName)
+		{	std::lock_guard<std::mutex> guard(lock);
+			if(!(nCacheHits + nCacheMisses)) return;
+			logPrintf("MEMUSAGE: %30s %12.6lf GB (peak cached), %.1lf%% of %lu allocations reused\n",
+				(string(spaceName) + " buffer cache").c_str(), cachePeak/pow(1024.,3),
+				(100.*nCacheHits)/(nCacheHits + nCacheMisses), nCacheHits + nCacheMisses);
 		}
 	};
 	
@@ -261,6 +337,10 @@ namespace MemPool
 
 void ManagedMemoryBase::reportUsage()
 {	MemUsageReport::manager(MemUsageReport::Print);
+	MemPool::CPU().report("CPU");
+	#ifdef GPU_ENABLED
+	MemPool::GPU().report("GPU");
+	#endif
 }
 
 //Free memory
@@ -269,12 +349,12 @@ void ManagedMemoryBase::memFree()
 	if(onGpu)
 	{
 		#ifdef GPU_ENABLED
-		MemPool::GPU().free(c);
+		MemPool::GPU().free(c, nBytes);
 		#else
 		assert(!"onGpu=true without GPU_ENABLED"); //Should never get here!
 		#endif
 	}
-	else MemPool::CPU().free(c);
+	else MemPool::CPU().free(c, nBytes);
 	MemUsageReport::manager(MemUsageReport::Remove, category, nBytes);
 	c = 0;
 	nBytes = 0;
@@ -316,7 +396,7 @@ void ManagedMemoryBase::toCpu() const
 	ManagedMemoryBase& me = *((ManagedMemoryBase*)this);
 	void* cCpu = MemPool::CPU().alloc(nBytes);
 	cudaMemcpy(cCpu, me.c, nBytes, cudaMemcpyDeviceToHost);
-	MemPool::GPU().free(me.c); //Free GPU mem
+	MemPool::GPU().free(me.c, nBytes); //Free GPU mem
 	me.c = cCpu; //Make c a cpu pointer
 	me.onGpu = false;
 #endif
@@ -330,7 +410,7 @@ void ManagedMemoryBase::toGpu() const
 	ManagedMemoryBase& me = *((ManagedMemoryBase*)this);
 	void* cGpu = MemPool::GPU().alloc(nBytes);
 	cudaMemcpy(cGpu, me.c, nBytes, cudaMemcpyHostToDevice);
-	MemPool::CPU().free(me.c); //Free CPU mem
+	MemPool::CPU().free(me.c, nBytes); //Free CPU mem
 	me.c = cGpu; //Make c a gpu pointer
 	me.onGpu = true;
 #else
@@ -111,6 +111,7 @@ public:
 	void recv(int src, int tag=0); //!< receive from another process
 	void bcast(int root=0); //!< synchronize across processes (using value on specified root process)
 	void allReduce(MPIUtil::ReduceOp op, bool safeMode=false); //!< apply all-to-all reduction (see MPIUtil::allReduce)
+	MPIUtil::Request allReduceAsync(MPIUtil::ReduceOp op); //!< start a non-blocking all-to-all reduction (see MPIUtil::allReduceAsync); data must not be accessed until mpiUtil->wait() on the returned request
 
 	void read(const char *fname); //!< binary read from a file
 	void read(FILE *filep); //!< binary read from a stream
@@ -280,6 +281,9 @@ template<typename T> void ManagedMemory<T>::allReduce(MPIUtil::ReduceOp op, bool
 {	if(mpiUtil->nProcesses()>1)
 		mpiUtil->allReduce(dataMPI(), nData(), op, safeMode);
 }
+template<typename T> MPIUtil::Request ManagedMemory<T>::allReduceAsync(MPIUtil::ReduceOp op)
+{	return mpiUtil->allReduceAsync(dataMPI(), nData(), op);
+}
 #undef dataMPI
 
 template<typename T> void memcpy(ManagedMemory<T>& a, const ManagedMemory<T>& b)
@@ -0,0 +1,121 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/NeighborList.h>
+#include <core/LatticeUtils.h>
+#include <core/Util.h>
+#include <cfloat>
+
+const int nBinsMax = 64; //maximum number of bins along each direction
+const int nBinsPerCutoff = 3; //target number of bins per search radius along each direction
+
+NeighborList::NeighborList(double rCut, double rSkin) : rCut(rCut), rSkin(rSkin)
+{
+}
+
+bool NeighborList::update(const matrix3<>& R, const std::vector< vector3<> >& pos, vector3<bool> isTruncated)
+{	//Check if rebinning is necessary:
+	bool needRebin = (pos.size() != posBinned.size()) || (R != this->R) || !(isTruncated == this->isTruncated);
+	if(!needRebin)
+	{	double maxDispSq = 0.;
+		for(size_t i=0; i<pos.size(); i++)
+			maxDispSq = std::max(maxDispSq, RTR.metric_length_squared(pos[i] - posBinned[i]));
+		needRebin = (maxDispSq > std::pow(0.5*rSkin, 2));
+	}
+	if(!needRebin) return false;
+	//Rebin:
+	this->R = R;
+	RTR = (~R) * R;
+	this->isTruncated = isTruncated;
+	rebin(pos);
+	return true;
+}
+
+void NeighborList::rebin(const std::vector< vector3<> >& pos)
+{	static StopWatch watch("NeighborList::rebin"); watch.start();
+	size_t nAtoms = pos.size();
+	posBinned = pos;
+	cellOffset.assign(nAtoms, vector3<int>());
+	bin.resize(nAtoms);
+	double rSearch = rCut + rSkin;
+	matrix3<> G = (2*M_PI)*inv(R);
+	//Determine bin geometry along each direction:
+	vector3<> posMin, span; //origin and extent of binned region (in lattice coordinates)
+	vector3<int> binRange; //range of neighbouring bins to search along each lattice direction
+	for(int k=0; k<3; k++)
+	{	if(isTruncated[k])
+		{	double pMin = DBL_MAX, pMax = -DBL_MAX;
+			for(const vector3<>& p: pos)
+			{	pMin = std::min(pMin, p[k]);
+				pMax = std::max(pMax, p[k]);
+			}
+			posMin[k] = nAtoms ? pMin : 0.;
+			span[k] = nAtoms ? std::max(pMax-pMin, symmThreshold) : 1.;
+		}
+		else
+		{	posMin[k] = 0.;
+			span[k] = 1.;
+		}
+		double spanLength = span[k] * (2*M_PI) / G.row(k).length(); //extent perpendicular to other two lattice directions
+		nBins[k] = std::max(1, std::min(nBinsMax, int(floor(nBinsPerCutoff * spanLength / rSearch))));
+		binRange[k] = int(ceil(rSearch * nBins[k] / spanLength));
+		if(isTruncated[k]) binRange[k] = std::min(binRange[k], nBins[k]-1); //no images to search
+	}
+	//Select neighbouring bins that could contain atoms within rSearch:
+	//(separations from bin offset d lie within a box of half-width binWidth around d*binWidth in lattice coordinates)
+	vector3<> binWidth;
+	for(int k=0; k<3; k++) binWidth[k] = span[k] / nBins[k];
+	double halfDiagonal = 0.; //longest half-diagonal of that box
+	for(int s1=-1; s1<=1; s1+=2)
+	for(int s2=-1; s2<=1; s2+=2)
+		halfDiagonal = std::max(halfDiagonal, sqrt(RTR.metric_length_squared(vector3<>(binWidth[0], s1*binWidth[1], s2*binWidth[2]))));
+	binOffsets.clear();
+	vector3<int> d;
+	for(d[0]=-binRange[0]; d[0]<=binRange[0]; d[0]++)
+	for(d[1]=-binRange[1]; d[1]<=binRange[1]; d[1]++)
+	for(d[2]=-binRange[2]; d[2]<=binRange[2]; d[2]++)
+	{	vector3<> xCenter; for(int k=0; k<3; k++) xCenter[k] = d[k] * binWidth[k];
+		if(sqrt(RTR.metric_length_squared(xCenter)) - halfDiagonal < rSearch)
+			binOffsets.push_back(d);
+	}
+	//Bin the atoms:
+	size_t nBinsTot = nBins[0]*size_t(nBins[1]*nBins[2]);
+	std::vector<size_t> binCount(nBinsTot, 0);
+	std::vector<size_t> binIndex(nAtoms);
+	for(size_t i=0; i<nAtoms; i++)
+	{	for(int k=0; k<3; k++)
+		{	double p = (pos[i][k] - posMin[k]) / span[k];
+			if(!isTruncated[k])
+			{	cellOffset[i][k] = int(floor(p));
+				p -= cellOffset[i][k];
+			}
+			bin[i][k] = std::max(0, std::min(nBins[k]-1, int(floor(p * nBins[k]))));
+		}
+		binIndex[i] = bin[i][0] + nBins[0]*size_t(bin[i][1] + nBins[1]*bin[i][2]);
+		binCount[binIndex[i]]++;
+	}
+	binStart.assign(nBinsTot+1, 0);
+	for(size_t iBin=0; iBin<nBinsTot; iBin++)
+		binStart[iBin+1] = binStart[iBin] + binCount[iBin];
+	binAtoms.resize(nAtoms);
+	std::vector<size_t> binNext(binStart.begin(), binStart.end()-1);
+	for(size_t i=0; i<nAtoms; i++)
+		binAtoms[binNext[binIndex[i]]++] = i;
+	watch.stop();
+}
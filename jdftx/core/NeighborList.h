@@ -0,0 +1,101 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_NEIGHBORLIST_H
+#define JDFTX_CORE_NEIGHBORLIST_H
+
+//! @addtogroup LongRange
+//! @{
+
+//! @file NeighborList.h Cell-list neighbour search for real-space pair sums
+
+#include <core/matrix3.h>
+#include <core/Thread.h>
+#include <vector>
+
+//! Cell-list neighbour search for pair sums over atoms and their periodic images within a cutoff.
+//! Atoms are binned on a mesh commensurate with the lattice (with bins smaller than the cutoff), and only
+//! those neighbouring bins (with periodic wrapping of bins yielding the images) that could contain atoms
+//! within rCut+rSkin of an atom in the central bin are searched.
+//! The binning is redone only when the lattice changes or some atom moves by more than rSkin/2 since the last binning.
+class NeighborList
+{
+public:
+	NeighborList(double rCut, double rSkin=1.);
+
+	//! Update for lattice vectors R and atom positions pos (in lattice coordinates), excluding periodic
+	//! images along truncated directions. Returns true if the atoms were re-binned.
+	bool update(const matrix3<>& R, const std::vector< vector3<> >& pos, vector3<bool> isTruncated=vector3<bool>(false,false,false));
+
+	//! Call f(i, j, x, rSq) for each atom i and each periodic image of atom j within rCut of it (excluding i itself),
+	//! where x = iR + pos[i] - pos[j] is the separation in lattice coordinates and rSq its cartesian length squared.
+	//! The positions must be those of the last update(). The atoms i are distributed over threads, so f may only
+	//! modify quantities associated with atom i. Returns the sum of return values of f over all pairs.
+	template<typename Func> double pairSum(const std::vector< vector3<> >& pos, const Func& f) const
+	{	return threadedAccumulate(pairSum_calc<Func>, pos.size(), this, &pos, &f);
+	}
+
+private:
+	double rCut, rSkin;
+	matrix3<> R, RTR; //lattice vectors and metric at last binning
+	vector3<bool> isTruncated; //directions without periodic images
+	std::vector< vector3<> > posBinned; //positions at last binning
+	std::vector< vector3<int> > cellOffset; //integer part of positions removed in binning (zero along truncated directions)
+	std::vector< vector3<int> > bin; //bin of each atom
+	vector3<int> nBins; //number of bins along each lattice direction
+	std::vector< vector3<int> > binOffsets; //offsets of neighbouring bins to search (within cutoff sphere)
+	std::vector<size_t> binStart; //start of each bin in binAtoms (CSR format, with an extra entry at the end)
+	std::vector<int> binAtoms; //atom indices sorted by bin
+
+	void rebin(const std::vector< vector3<> >& pos);
+
+	template<typename Func> static double pairSum_calc(size_t i, const NeighborList* nl, const std::vector< vector3<> >* pos, const Func* f)
+	{	const vector3<int>& bin_i = nl->bin[i];
+		const vector3<int>& n_i = nl->cellOffset[i];
+		const double rCutSq = nl->rCut * nl->rCut;
+		double result = 0.;
+		vector3<int> b, w;
+		for(const vector3<int>& d: nl->binOffsets)
+		{	//Find bin and the image offset due to its periodic wrapping:
+			bool valid = true;
+			for(int k=0; k<3; k++)
+			{	b[k] = bin_i[k] + d[k];
+				w[k] = floorDiv(b[k], nl->nBins[k]);
+				b[k] -= w[k] * nl->nBins[k];
+				if(w[k] && nl->isTruncated[k]) valid = false;
+			}
+			if(!valid) continue;
+			size_t iBin = b[0] + nl->nBins[0]*size_t(b[1] + nl->nBins[1]*b[2]);
+			//Loop over atoms in bin:
+			for(size_t jIndex=nl->binStart[iBin]; jIndex<nl->binStart[iBin+1]; jIndex++)
+			{	int j = nl->binAtoms[jIndex];
+				vector3<> x = (nl->cellOffset[j] - n_i - w) + (pos->at(i) - pos->at(j));
+				double rSq = nl->RTR.metric_length_squared(x);
+				if(!rSq || rSq >= rCutSq) continue; //exclude self-interaction and pairs beyond cutoff
+				result += (*f)(int(i), j, x, rSq);
+			}
+		}
+		return result;
+	}
+
+	static inline int floorDiv(int a, int b) { return (a>=0) ? a/b : -((b-1-a)/b); }
+};
+
+//! @}
+#endif // JDFTX_CORE_NEIGHBORLIST_H
@@ -127,11 +127,12 @@ complexScalarFieldTilde O(complexScalarFieldTilde&& in) { return in *= in->gInfo
 //Forward transform
 ScalarField I(ScalarFieldTilde&& in, int nThreads)
 {	//CPU c2r transforms destroy input, but this input can be destroyed
+	in->gInfo.profileFFT(1, true);
 	ScalarField out(ScalarFieldData::alloc(in->gInfo, isGpuEnabled()));
 	#ifdef GPU_ENABLED
 	cufftExecZ2D(in->gInfo.planZ2D, (double2*)in->dataGpu(false), out->dataGpu(false));
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = operatorThreadCount();
 	fftw_execute_dft_c2r(in->gInfo.getPlan(GridInfo::PlanCtoR, nThreads),
 		(fftw_complex*)in->data(false), out->data(false));
 	#endif
@@ -148,10 +149,11 @@ ScalarField I(const ScalarFieldTilde& in, int nThreads)
 }
 complexScalarField I(const complexScalarFieldTilde& in, int nThreads)
 {	complexScalarField out(complexScalarFieldData::alloc(in->gInfo, isGpuEnabled()));
+	in->gInfo.profileFFT();
 	#ifdef GPU_ENABLED
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)out->dataGpu(false), CUFFT_INVERSE);
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = operatorThreadCount();
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanInverse, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)out->data(false));
 	#endif
@@ -160,10 +162,11 @@ complexScalarField I(const complexScalarFieldTilde& in, int nThreads)
 }
 complexScalarField I(complexScalarFieldTilde&& in, int nThreads)
 {	//Destructible input (transform in place):
+	in->gInfo.profileFFT();
 	#ifdef GPU_ENABLED
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)in->dataGpu(false), CUFFT_INVERSE);
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = operatorThreadCount();
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanInverseInPlace, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)in->data(false));
 	#endif
@@ -173,11 +176,12 @@ complexScalarField I(complexScalarFieldTilde&& in, int nThreads)
 //Forward transform h.c.
 ScalarFieldTilde Idag(const ScalarField& in, int nThreads)
 {	//r2c transform does not destroy input (no backing up needed)
+	in->gInfo.profileFFT(1, true);
 	ScalarFieldTilde out(ScalarFieldTildeData::alloc(in->gInfo, isGpuEnabled()));
 	#ifdef GPU_ENABLED
 	cufftExecD2Z(in->gInfo.planD2Z, in->dataGpu(false), (double2*)out->dataGpu(false));
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = operatorThreadCount();
 	fftw_execute_dft_r2c(in->gInfo.getPlan(GridInfo::PlanRtoC, nThreads),
 		in->data(false), (fftw_complex*)out->data(false));
 	#endif
@@ -186,10 +190,11 @@ ScalarFieldTilde Idag(const ScalarField& in, int nThreads)
 }
 complexScalarFieldTilde Idag(const complexScalarField& in, int nThreads)
 {	complexScalarFieldTilde out(complexScalarFieldTildeData::alloc(in->gInfo, isGpuEnabled()));
+	in->gInfo.profileFFT();
 	#ifdef GPU_ENABLED
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)out->dataGpu(false), CUFFT_FORWARD);
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = operatorThreadCount();
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanForward, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)out->data(false));
 	#endif
@@ -198,10 +203,11 @@ complexScalarFieldTilde Idag(const complexScalarField& in, int nThreads)
 }
 complexScalarFieldTilde Idag(complexScalarField&& in, int nThreads)
 {	//Destructible input (transform in place):
+	in->gInfo.profileFFT();
 	#ifdef GPU_ENABLED
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)in->dataGpu(false), CUFFT_FORWARD);
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = operatorThreadCount();
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanForwardInPlace, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)in->data(false));
 	#endif
@@ -0,0 +1,351 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/Util.h>
+#include <core/GpuUtil.h>
+#include <mutex>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#ifdef ENABLE_PROFILING
+bool StopWatch::profilingEnabled = true;
+#else
+bool StopWatch::profilingEnabled = false;
+#endif
+
+namespace Profiler
+{
+	//Node in the tree of timed regions on one thread:
+	struct Region
+	{	const StopWatch* watch; //null for the root
+		int parent; //index of parent region (-1 for root)
+		std::map<const StopWatch*,int> children; //indices of child regions by watch
+		double tStart, Ttot, TsqTot; //start time of current call, and accumulated time and squared time (in us)
+		double flops, bytes; //accumulated operation and memory-traffic counts
+		long nCalls;
+		Region(const StopWatch* watch, int parent) : watch(watch), parent(parent), tStart(0), Ttot(0), TsqTot(0), flops(0), bytes(0), nCalls(0) {}
+	};
+	
+	//Completed call of a region (for trace output):
+	struct TraceEvent
+	{	const StopWatch* watch;
+		int iThread; //thread on which the call occurred
+		double tStart, duration; //in us
+	};
+	const size_t maxTraceEvents = 1<<20; //per thread, to bound memory usage
+	
+	//Profiling data for one thread:
+	struct ThreadData
+	{	int iThread;
+		std::vector<Region> regions;
+		int current; //index of innermost open region
+		std::vector<TraceEvent> trace;
+		ThreadData(int iThread) : iThread(iThread), regions(1, Region(0,-1)), current(0) {}
+	};
+	
+	//Profiling data shared between threads (allocated once and never freed, so that it remains valid for threads exiting during static destruction):
+	struct SharedData
+	{	std::mutex lock;
+		std::vector<ThreadData*> threads; //running threads
+		ThreadData exited; //regions and trace events merged over threads that have exited (iThread = -1)
+		int nThreadsStarted;
+		SharedData() : exited(-1), nThreadsStarted(0) {}
+	};
+	SharedData& shared()
+	{	static SharedData* sd = new SharedData;
+		return *sd;
+	}
+	string outFilename; //JSON or trace output file name (empty if log output only)
+	bool traceOutput = false; //whether outFilename is a Chrome trace (else a region tree)
+	
+	//Accumulate the subtree of src at iSrc into the subtree of dest at iDest (matching regions by watch)
+	void mergeRegions(ThreadData& dest, int iDest, const ThreadData& src, int iSrc)
+	{	for(const auto& child: src.regions[iSrc].children)
+		{	auto iter = dest.regions[iDest].children.find(child.first);
+			int iRegion;
+			if(iter == dest.regions[iDest].children.end())
+			{	iRegion = dest.regions.size();
+				dest.regions[iDest].children[child.first] = iRegion;
+				dest.regions.push_back(Region(child.first, iDest));
+			}
+			else iRegion = iter->second;
+			Region& r = dest.regions[iRegion];
+			const Region& rSrc = src.regions[child.second];
+			r.Ttot += rSrc.Ttot;
+			r.TsqTot += rSrc.TsqTot;
+			r.flops += rSrc.flops;
+			r.bytes += rSrc.bytes;
+			r.nCalls += rSrc.nCalls;
+			mergeRegions(dest, iRegion, src, child.second);
+		}
+	}
+	
+	//Owner of the profiling data of a thread, which merges it into SharedData::exited when the thread exits:
+	struct ThreadDataOwner
+	{	ThreadData* td;
+		ThreadDataOwner() : td(0) {}
+		~ThreadDataOwner()
+		{	if(!td) return;
+			SharedData& sd = shared();
+			std::lock_guard<std::mutex> lock(sd.lock);
+			mergeRegions(sd.exited, 0, *td, 0);
+			size_t nTrace = std::min(td->trace.size(), maxTraceEvents - std::min(maxTraceEvents, sd.exited.trace.size()));
+			sd.exited.trace.insert(sd.exited.trace.end(), td->trace.begin(), td->trace.begin()+nTrace);
+			sd.threads.erase(std::find(sd.threads.begin(), sd.threads.end(), td));
+			delete td;
+		}
+	};
+	
+	ThreadData& getThreadData()
+	{	static thread_local ThreadDataOwner owner;
+		if(!owner.td)
+		{	SharedData& sd = shared();
+			std::lock_guard<std::mutex> lock(sd.lock);
+			owner.td = new ThreadData(sd.nThreadsStarted++);
+			sd.threads.push_back(owner.td);
+		}
+		return *owner.td;
+	}
+	
+	//List of profiling data for all threads, including those that have exited (call with SharedData::lock held):
+	std::vector<const ThreadData*> allThreadData()
+	{	SharedData& sd = shared();
+		std::vector<const ThreadData*> all(sd.threads.begin(), sd.threads.end());
+		if(sd.exited.regions.size()>1 || sd.exited.trace.size()) all.push_back(&sd.exited);
+		return all;
+	}
+	
+	//Quote a string for JSON output
+	string jsonString(const string& s)
+	{	string out = "\"";
+		for(char c: s)
+		{	if(c=='"' || c=='\\') out += '\\';
+			out += c;
+		}
+		return out + "\"";
+	}
+	
+	//Write the subtree of regions starting at iRegion as JSON
+	void writeJSON(ostringstream& oss, const ThreadData& td, int iRegion, string indent)
+	{	const Region& r = td.regions[iRegion];
+		oss << indent << "{ \"name\": " << jsonString(r.watch ? r.watch->getName() : "root");
+		if(r.watch)
+			oss << ", \"calls\": " << r.nCalls << ", \"time\": " << r.Ttot*1e-6 << ", \"timeSq\": " << r.TsqTot*1e-12
+				<< ", \"flops\": " << r.flops << ", \"bytes\": " << r.bytes;
+		oss << ", \"children\": [";
+		bool first = true;
+		for(const auto& child: r.children)
+		{	oss << (first ? "\n" : ",\n");
+			writeJSON(oss, td, child.second, indent+"  ");
+			first = false;
+		}
+		oss << (first ? "] }" : ("\n" + indent + "] }"));
+	}
+	
+	//Flatten regions of the subtree at iRegion into path -> statistics (path components separated by tabs, so that sorting yields depth-first order)
+	struct Stats
+	{	double T, Tmax, flops, bytes; long nCalls;
+		Stats() : T(0), Tmax(0), flops(0), bytes(0), nCalls(0) {}
+	};
+	void flatten(const ThreadData& td, int iRegion, const string& prefix, std::map<string,Stats>& out)
+	{	for(const auto& child: td.regions[iRegion].children)
+		{	const Region& r = td.regions[child.second];
+			string path = prefix + (prefix.length() ? "\t" : "") + r.watch->getName();
+			Stats& s = out[path];
+			s.T += r.Ttot*1e-6;
+			s.flops += r.flops;
+			s.bytes += r.bytes;
+			s.nCalls += r.nCalls;
+			flatten(td, child.second, path, out);
+		}
+	}
+	
+	//Collect strings from all processes on the head
+	void gatherStrings(const string& mine, std::vector<string>& all)
+	{	all.assign(mpiUtil->nProcesses(), string());
+		all[mpiUtil->iProcess()] = mine;
+		for(int jProc=1; jProc<mpiUtil->nProcesses(); jProc++)
+		{	if(mpiUtil->isHead()) mpiUtil->recv(all[jProc], jProc, jProc);
+			else if(mpiUtil->iProcess()==jProc) mpiUtil->send(mine, 0, jProc);
+		}
+	}
+}
+
+using namespace Profiler;
+
+void StopWatch::startRegion()
+{
+	#ifdef GPU_ENABLED
+	cudaThreadSynchronize();
+	#endif
+	ThreadData& td = getThreadData();
+	auto iter = td.regions[td.current].children.find(this);
+	int iRegion;
+	if(iter == td.regions[td.current].children.end())
+	{	iRegion = td.regions.size();
+		td.regions[td.current].children[this] = iRegion;
+		td.regions.push_back(Region(this, td.current));
+	}
+	else iRegion = iter->second;
+	td.current = iRegion;
+	td.regions[iRegion].tStart = clock_us();
+}
+
+void StopWatch::stopRegion()
+{
+	#ifdef GPU_ENABLED
+	cudaThreadSynchronize();
+	#endif
+	double tStop = clock_us();
+	ThreadData& td = getThreadData();
+	//Find the innermost open region of this watch (sections left open by early returns are closed along with it):
+	int iRegion = td.current;
+	while(iRegion>0 && td.regions[iRegion].watch!=this) iRegion = td.regions[iRegion].parent;
+	if(iRegion <= 0) return; //not started on this thread (e.g. profiling enabled in between)
+	Region& r = td.regions[iRegion];
+	double T = tStop - r.tStart;
+	r.Ttot += T;
+	r.TsqTot += T*T;
+	r.nCalls++;
+	if(traceOutput && td.trace.size()<maxTraceEvents)
+	{	TraceEvent event = { this, td.iThread, r.tStart, T };
+		td.trace.push_back(event);
+	}
+	td.current = r.parent;
+}
+
+void profileCountsRegion(double flops, double bytes)
+{	ThreadData& td = getThreadData();
+	Region& r = td.regions[td.current];
+	r.flops += flops;
+	r.bytes += bytes;
+}
+
+void StopWatch::initProfiling()
+{	const char* profileStr = getenv("JDFTX_PROFILE");
+	if(!profileStr) return;
+	profilingEnabled = true;
+	string profileSpec(profileStr);
+	if(profileSpec == "log")
+		logPrintf("Profiling enabled (output to log only).\n");
+	else
+	{	outFilename = profileSpec;
+		const string traceSuffix(".trace");
+		traceOutput = (outFilename.length() > traceSuffix.length())
+			&& (outFilename.substr(outFilename.length()-traceSuffix.length()) == traceSuffix);
+		logPrintf("Profiling enabled (output to log and %s file '%s').\n",
+			traceOutput ? "Chrome trace" : "JSON", outFilename.c_str());
+	}
+}
+
+void StopWatch::reportProfiling()
+{	if(!profilingEnabled) return;
+	
+	//Flatten regions from all threads on this process:
+	std::map<string,Stats> stats;
+	shared().lock.lock();
+	for(const ThreadData* td: allThreadData())
+		flatten(*td, 0, string(), stats);
+	shared().lock.unlock();
+	
+	//Combine statistics across processes on head:
+	ostringstream ossStats;
+	ossStats.precision(12);
+	for(const auto& entry: stats)
+		ossStats << entry.second.T << ' ' << entry.second.flops << ' ' << entry.second.bytes << ' ' << entry.second.nCalls << ' ' << entry.first << '\n';
+	std::vector<string> statsAll;
+	gatherStrings(ossStats.str(), statsAll);
+	if(mpiUtil->isHead())
+	{	std::map<string,Stats> statsTot;
+		for(const string& statsStr: statsAll)
+		{	istringstream iss(statsStr);
+			string line;
+			while(getline(iss, line))
+			{	istringstream issLine(line);
+				Stats s; issLine >> s.T >> s.flops >> s.bytes >> s.nCalls;
+				string path; issLine.get(); getline(issLine, path);
+				Stats& sTot = statsTot[path];
+				sTot.T += s.T;
+				sTot.Tmax = std::max(sTot.Tmax, s.T);
+				sTot.flops += s.flops;
+				sTot.bytes += s.bytes;
+				sTot.nCalls += s.nCalls;
+			}
+		}
+		//Print nested summary:
+		int nProcs = mpiUtil->nProcesses();
+		logPrintf("\n");
+		for(const auto& entry: statsTot)
+		{	const string& path = entry.first;
+			const Stats& s = entry.second;
+			size_t nameStart = path.rfind('\t'); nameStart = (nameStart==string::npos) ? 0 : nameStart+1;
+			int depth = std::count(path.begin(), path.end(), '\t');
+			string label = string(2*depth, ' ') + path.substr(nameStart);
+			logPrintf("PROFILER: %-40s %12.6lf s avg %12.6lf s max %9ld calls", label.c_str(), s.T/nProcs, s.Tmax, s.nCalls/nProcs);
+			if(s.flops && s.T) logPrintf(" %9.3lf GFLOP/s %9.3lf GB/s", 1e-9*s.flops/s.T, 1e-9*s.bytes/s.T);
+			logPrintf("\n");
+		}
+		logPrintf("PROFILER: times are summed over threads and averaged over %d processes (max over processes alongside).\n", nProcs);
+	}
+	
+	//Write requested output file:
+	if(!outFilename.length()) return;
+	ostringstream oss;
+	oss.precision(12);
+	shared().lock.lock();
+	bool first = true;
+	for(const ThreadData* td: allThreadData())
+	{	if(traceOutput)
+		{	for(const TraceEvent& event: td->trace)
+			{	oss << (first ? "" : ",\n") << "{ \"name\": " << jsonString(event.watch->getName())
+					<< ", \"ph\": \"X\", \"pid\": " << mpiUtil->iProcess() << ", \"tid\": " << event.iThread
+					<< ", \"ts\": " << event.tStart << ", \"dur\": " << event.duration << " }";
+				first = false;
+			}
+		}
+		else
+		{	oss << (first ? "" : ",\n") << "    { \"thread\": " << td->iThread << ", \"regions\":\n";
+			writeJSON(oss, *td, 0, "      ");
+			oss << " }";
+			first = false;
+		}
+	}
+	shared().lock.unlock();
+	std::vector<string> outAll;
+	gatherStrings(oss.str(), outAll);
+	if(mpiUtil->isHead())
+	{	FILE* fp = fopen(outFilename.c_str(), "w");
+		if(!fp) { logPrintf("WARNING: could not open '%s' for writing profile.\n", outFilename.c_str()); return; }
+		fprintf(fp, traceOutput ? "[\n" : "{ \"processes\": [\n");
+		bool firstOut = true;
+		for(int jProc=0; jProc<mpiUtil->nProcesses(); jProc++)
+		{	if(traceOutput)
+			{	if(!outAll[jProc].length()) continue;
+				fprintf(fp, "%s%s", (firstOut ? "" : ",\n"), outAll[jProc].c_str());
+				firstOut = false;
+			}
+			else
+				fprintf(fp, "  { \"process\": %d, \"threads\": [\n%s\n  ] }%s\n", jProc, outAll[jProc].c_str(), (jProc+1<mpiUtil->nProcesses()) ? "," : "");
+		}
+		fprintf(fp, traceOutput ? "\n]\n" : "] }\n");
+		fclose(fp);
+		logPrintf("Wrote profile to '%s'.\n", outFilename.c_str());
+	}
+}
@@ -44,6 +44,7 @@ public:
 	
 	void loadState(const char* filename); //!< Load the state from a single binary file
 	void saveState(const char* filename) const; //!< Save the state to a single binary file
+	void saveState(FILE* fp) const; //!< Save the state to a stream (eg. for checkpoints)
 	void clearState(); //!< remove past variables and residuals
 	
 	//! Override to synchronize scalars over MPI processes (if the same minimization is happening in sync over many processes)
@@ -263,14 +264,18 @@ template<typename Variable> void Pulay<Variable>::saveState(const char* filename
 {
 	if(mpiUtil->isHead())
 	{	FILE* fp = fopen(filename, "w");
-		for(size_t idim=0; idim<pastVariables.size(); idim++)
-		{	writeVariable(pastVariables[idim], fp);
-			writeVariable(pastResiduals[idim], fp);
-		}
+		saveState(fp);
 		fclose(fp);
 	}
 }
 
+template<typename Variable> void Pulay<Variable>::saveState(FILE* fp) const
+{	for(size_t idim=0; idim<pastVariables.size(); idim++)
+	{	writeVariable(pastVariables[idim], fp);
+		writeVariable(pastResiduals[idim], fp);
+	}
+}
+
 template<typename Variable> void Pulay<Variable>::clearState()
 {	pastVariables.clear();
 	pastResiduals.clear();
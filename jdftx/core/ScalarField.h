@@ -102,6 +102,7 @@ template<typename T> struct FieldData : private ManagedMemory<T>
 	inline void recv(int src, int tag=0) { absorbScale(); ManagedMemory<T>::recv(src,tag); } //!< receive from another process
 	inline void bcast(int root=0) { absorbScale(); ManagedMemory<T>::bcast(root); } //!< synchronize across processes (using value on specified root process)
 	inline void allReduce(MPIUtil::ReduceOp op, bool safeMode=false) { absorbScale(); ManagedMemory<T>::allReduce(op, safeMode); } //!< apply all-to-all reduction
+	inline MPIUtil::Request allReduceAsync(MPIUtil::ReduceOp op) { absorbScale(); return ManagedMemory<T>::allReduceAsync(op); } //!< start non-blocking all-to-all reduction (see ManagedMemory::allReduceAsync)
 
 protected:
 	struct PrivateTag {}; //!< Used to prevent direct use of ScalarField constructors, and force the shared_ptr usage
@@ -0,0 +1,77 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_SIMD_H
+#define JDFTX_CORE_SIMD_H
+
+//! @addtogroup Utilities
+//! @{
+
+//! @file Simd.h Vectorization of pointwise CPU kernels
+
+#include <cmath>
+
+//! @def SIMD_LOOP
+//! Placed before the innermost loop of a pointwise kernel (one that has no dependencies between iterations)
+//! to request vectorization of the loop. With SIMD_ENABLED (CMake option EnableSIMD), this is an OpenMP SIMD
+//! directive, and the math functions declared below are vectorized using the glibc vector math library (libmvec).
+//! Otherwise, it expands to nothing and the loop is compiled as a regular scalar loop.
+//! Loop bodies should be branch-free (compute all alternatives and select with ?:) for the vectorization to succeed.
+
+//! @def SIMD_BRANCHFREE
+//! Defined along with a vectorizing SIMD_LOOP; kernels shared with the scalar and GPU builds select their
+//! branch-free variants (which evaluate all alternatives) only when this is defined, and otherwise keep
+//! the branched versions that skip the unused alternatives.
+
+#if defined(SIMD_ENABLED) && !defined(__in_a_cu_file__)
+	#define SIMD_LOOP _Pragma("omp simd")
+	#define SIMD_BRANCHFREE
+
+	//Vector variants of math functions available in libmvec (x86-64 glibc):
+	#if defined(__GLIBC__) && defined(__x86_64__)
+	extern "C"
+	{
+		#if __GLIBC_PREREQ(2,22)
+		#pragma omp declare simd notinbranch
+		double exp(double) noexcept;
+		#pragma omp declare simd notinbranch
+		double log(double) noexcept;
+		#endif
+		#if __GLIBC_PREREQ(2,28)
+		#pragma omp declare simd notinbranch
+		double pow(double, double) noexcept;
+		#endif
+		#if __GLIBC_PREREQ(2,35)
+		#pragma omp declare simd notinbranch
+		double atan(double) noexcept;
+		#pragma omp declare simd notinbranch
+		double tanh(double) noexcept;
+		#pragma omp declare simd notinbranch
+		double sinh(double) noexcept;
+		#pragma omp declare simd notinbranch
+		double erfc(double) noexcept;
+		#endif
+	}
+	#endif
+#else
+	#define SIMD_LOOP
+#endif
+
+//! @}
+#endif // JDFTX_CORE_SIMD_H
@@ -28,6 +28,9 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Util.h>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <functional>
+#include <algorithm>
 #include <unistd.h>
 
 extern int nProcsAvailable; //!< number of available processors (initialized to number of online processors, can be overriden)
@@ -47,6 +50,21 @@ bool shouldThreadOperators();
 void suspendOperatorThreading(); //!< call from multi-threaded top-level code to disable threading within operators called from a parallel section
 void resumeOperatorThreading(); //!< call after a parallel section in top-level code to resume threading within subsequent operator calls
 
+//! Number of threads that operators called from the current thread should use:
+//! all processors outside parallel sections, and one within parallel sections.
+int operatorThreadCount();
+
+extern bool threadPinning; //!< if set, pin thread pool workers to distinct cores, filling one socket before the next (command-line option --pin-threads)
+void pinMainThread(int coreOffset); //!< pin calling thread to the first core of this process, where coreOffset is the number of cores used by preceding processes on this node (call before any threadLaunch)
+
+/**
+Run task(iThread) for 0 <= iThread < nThreads on the persistent thread pool, with the calling thread
+handling iThread = nThreads-1. Returns false without running anything if the pool is already in use
+(nested or concurrent launches), in which case the caller must run the tasks on its own threads.
+This is used internally by threadLaunch, and need not be called directly.
+*/
+bool threadPoolRun(int nThreads, const std::function<void(int)>& task);
+
 
 /**
 @brief A simple utility for running muliple threads
@@ -115,8 +133,9 @@ Note that the calls are made from multiple threads, so func must
 be thread safe. (Hint: pass mutexes as a part of args if synchronization
 is required).
 
-As many threads as online processors are launched and the nIter iterations are evenly split
-between all the threads. Threaded loops will become single threaded if suspendOperatorThreading().
+As many threads as online processors are launched and the nIter iterations are distributed
+dynamically in chunks (of about nIter/(threadedLoopChunksPerThread*nThreads) iterations) to balance load.
+Threaded loops will become single threaded if suspendOperatorThreading().
 
 @param func The function / object with operator() to be looped over
 @param nIter The number of loop 'iterations'
@@ -125,6 +144,8 @@ between all the threads. Threaded loops will become single threaded if suspendOp
 template<typename Callable,typename ... Args>
 void threadedLoop(Callable* func, size_t nIter, Args... args);
 
+const size_t threadedLoopChunksPerThread = 8; //!< average number of chunks handled by each thread in threadedLoop and threadedAccumulate
+
 
 /**
 @brief A parallelized loop with an accumulated return value
@@ -145,21 +166,27 @@ double threadedAccumulate(Callable* func, size_t nIter, Args... args);
 
 template<typename Callable,typename ... Args>
 void threadLaunch(int nThreads, Callable* func, size_t nJobs, Args... args)
-{	if(nThreads<=0) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
-	if(nThreads>1) suspendOperatorThreading(); //Prevent func and anything it calls from launching nested threads
-	std::thread** tArr = new std::thread*[nThreads-1];
-	for(int t=0; t<nThreads; t++)
+{	if(nThreads<=0) nThreads = operatorThreadCount();
+	auto task = [&](int t)
 	{	size_t i1 = (nJobs>0 ? (  t   * nJobs)/nThreads : t);
 		size_t i2 = (nJobs>0 ? ((t+1) * nJobs)/nThreads : nThreads);
-		if(t<nThreads-1) tArr[t] = new std::thread(func, i1, i2, args...);
-		else (*func)(i1, i2, args...);
-	}
-	for(int t=0; t<nThreads-1; t++)
-	{	tArr[t]->join();
-		delete tArr[t];
+		(*func)(i1, i2, args...);
+	};
+	if(nThreads==1) { task(0); return; }
+	suspendOperatorThreading(); //Prevent func and anything it calls from launching nested threads
+	if(!threadPoolRun(nThreads, task))
+	{	//Pool busy (launch from within another parallel section): spawn threads for this call
+		std::thread** tArr = new std::thread*[nThreads-1];
+		for(int t=0; t<nThreads-1; t++)
+			tArr[t] = new std::thread(task, t);
+		task(nThreads-1);
+		for(int t=0; t<nThreads-1; t++)
+		{	tArr[t]->join();
+			delete tArr[t];
+		}
+		delete[] tArr;
 	}
-	delete[] tArr;
-	if(nThreads>1) resumeOperatorThreading(); //End nested threading guard section
+	resumeOperatorThreading(); //End nested threading guard section
 }
 
 template<typename Callable,typename ... Args>
@@ -182,26 +209,40 @@ void threadLaunch(AutoThreadCount* atc, Callable* func, size_t nJobs, Args... ar
 }
 
 
+//Chunked dynamic schedule: each thread repeatedly claims the next chunk of iterations from iNext
+inline bool threadedLoop_nextChunk(int nThreads, size_t nIter, std::atomic<size_t>* iNext, size_t& iStart, size_t& iStop)
+{	size_t chunkSize = std::max(size_t(1), nIter/(threadedLoopChunksPerThread*nThreads));
+	iStart = iNext->fetch_add(chunkSize);
+	iStop = std::min(iStart+chunkSize, nIter);
+	return iStart < nIter;
+}
+
 template<typename Callable,typename ... Args>
-void threadedLoop_sub(size_t iMin, size_t iMax, Callable* func, Args... args)
-{	for(size_t i=iMin; i<iMax; i++) (*func)(i, args...);
+void threadedLoop_sub(int iThread, int nThreads, size_t nIter, std::atomic<size_t>* iNext, Callable* func, Args... args)
+{	size_t iStart, iStop;
+	while(threadedLoop_nextChunk(nThreads, nIter, iNext, iStart, iStop))
+		for(size_t i=iStart; i<iStop; i++) (*func)(i, args...);
 }
 template<typename Callable,typename ... Args>
 void threadedLoop(Callable* func, size_t nIter, Args... args)
-{	threadLaunch(threadedLoop_sub<Callable,Args...>, nIter, func, args...);
+{	std::atomic<size_t> iNext(0);
+	threadLaunch(threadedLoop_sub<Callable,Args...>, 0, nIter, &iNext, func, args...);
 }
 
 template<typename Callable,typename ... Args>
-void threadedAccumulate_sub(size_t iMin, size_t iMax, Callable* func, double* accumTot, std::mutex* m, Args... args)
+void threadedAccumulate_sub(int iThread, int nThreads, size_t nIter, std::atomic<size_t>* iNext, Callable* func, double* accumTot, std::mutex* m, Args... args)
 {	double accum=0.0;
-	for(size_t i=iMin; i<iMax; i++) accum += (*func)(i, args...);
+	size_t iStart, iStop;
+	while(threadedLoop_nextChunk(nThreads, nIter, iNext, iStart, iStop))
+		for(size_t i=iStart; i<iStop; i++) accum += (*func)(i, args...);
 	m->lock(); *accumTot += accum; m->unlock();
 }
 template<typename Callable,typename ... Args>
 double threadedAccumulate(Callable* func, size_t nIter, Args... args)
 {	double accumTot=0.0;
 	std::mutex m;
-	threadLaunch(threadedAccumulate_sub<Callable,Args...>, nIter, func, &accumTot, &m, args...);
+	std::atomic<size_t> iNext(0);
+	threadLaunch(threadedAccumulate_sub<Callable,Args...>, 0, nIter, &iNext, func, &accumTot, &m, args...);
 	return accumTot;
 }
 
@@ -0,0 +1,133 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/Thread.h>
+#include <condition_variable>
+#include <algorithm>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+bool threadPinning = false;
+static int pinOffset = 0; //index of first core assigned to this process (see pinMainThread)
+
+static thread_local bool isPoolWorker = false; //set on pool worker threads (to detect nested launches)
+static thread_local bool isPoolLauncher = false; //set on the thread running a parallel section on the pool (to detect nested launches)
+
+//Persistent pool of worker threads: workers sleep on a condition variable between parallel sections
+class ThreadPool
+{
+public:
+	ThreadPool() : task(0), nActive(0), nPending(0), generation(0) {}
+	
+	bool run(int nThreads, const std::function<void(int)>& task)
+	{	if(isPoolWorker || isPoolLauncher || !launchLock.try_lock())
+			return false; //nested or concurrent launch: caller should use its own threads
+		isPoolLauncher = true;
+		{	std::unique_lock<std::mutex> lock(m);
+			while(int(workers.size()) < nThreads-1) //grow pool on demand
+			{	workers.push_back(std::thread(&ThreadPool::worker, this, int(workers.size())));
+				workers.back().detach(); //pool lives till the end of the program
+			}
+			this->task = &task;
+			nActive = nThreads;
+			nPending = nThreads-1;
+			generation++;
+		}
+		cvStart.notify_all();
+		task(nThreads-1); //calling thread handles the last chunk (as in the original spawning version)
+		{	std::unique_lock<std::mutex> lock(m);
+			cvDone.wait(lock, [this]{ return nPending==0; });
+			this->task = 0;
+		}
+		isPoolLauncher = false;
+		launchLock.unlock();
+		return true;
+	}
+	
+private:
+	std::mutex launchLock; //held for the duration of each parallel section
+	std::mutex m; //protects the state below
+	std::condition_variable cvStart, cvDone;
+	std::vector<std::thread> workers;
+	const std::function<void(int)>* task;
+	int nActive, nPending; //number of threads in current section, and number of workers yet to finish
+	size_t generation; //incremented for each parallel section
+	
+	void worker(int iWorker)
+	{	isPoolWorker = true;
+		if(threadPinning) pin(iWorker+1); //core 0 is left to the calling thread
+		size_t generationDone = 0;
+		std::unique_lock<std::mutex> lock(m);
+		while(true)
+		{	cvStart.wait(lock, [&]{ return generation != generationDone; });
+			generationDone = generation;
+			if(iWorker < nActive-1)
+			{	const std::function<void(int)>& curTask = *task;
+				lock.unlock();
+				curTask(iWorker);
+				lock.lock();
+				if(!(--nPending)) cvDone.notify_one();
+			}
+		}
+	}
+	
+public:
+	//Pin current thread to the iCore'th core of this process, with allowed cores ordered by socket so that
+	//consecutive threads share a NUMA node before spilling over to the next one. Cores of a process start
+	//at pinOffset, unless the allowed set is already restricted to this process (e.g. by the job scheduler)
+	static void pin(int iCore)
+	{
+		#ifdef __linux__
+		cpu_set_t allowed;
+		if(sched_getaffinity(0, sizeof(allowed), &allowed)) return;
+		std::vector<std::pair<int,int>> cores; //(socket, cpu) pairs
+		for(int cpu=0; cpu<CPU_SETSIZE; cpu++)
+			if(CPU_ISSET(cpu, &allowed))
+			{	int socket = 0;
+				char fname[256]; sprintf(fname, "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+				FILE* fp = fopen(fname, "r");
+				if(fp)
+				{	if(fscanf(fp, "%d", &socket) != 1) socket = 0;
+					fclose(fp);
+				}
+				cores.push_back(std::make_pair(socket, cpu));
+			}
+		if(!cores.size()) return;
+		std::sort(cores.begin(), cores.end());
+		if(int(cores.size()) >= pinOffset + nProcsAvailable) iCore += pinOffset;
+		cpu_set_t target; CPU_ZERO(&target);
+		CPU_SET(cores[iCore % cores.size()].second, &target);
+		pthread_setaffinity_np(pthread_self(), sizeof(target), &target);
+		#endif
+	}
+};
+
+void pinMainThread(int coreOffset)
+{	pinOffset = coreOffset;
+	ThreadPool::pin(0);
+}
+
+bool threadPoolRun(int nThreads, const std::function<void(int)>& task)
+{	static ThreadPool* pool = new ThreadPool(); //never destroyed, so that exit() from any thread is safe
+	return pool->run(nThreads, task);
+}
@@ -56,6 +56,7 @@ void printUsage(const char *name, const char* description)
 	logPrintf("\t-m --mpi-debug-log      write output from secondary MPI processes to jdftx.<proc>.mpiDebugLog (instead of /dev/null)\n");
 	logPrintf("\t-n --dry-run            quit after initialization (to verify commands and other input files)\n");
 	logPrintf("\t-c --cores              number of cores to use (ignored when launched using SLURM)\n");
+	logPrintf("\t-p --pin-threads        pin threads to distinct cores (filling one socket before the next, with disjoint cores for processes on the same node)\n");
 	logPrintf("\t-s --skip-defaults      skip printing status of default commands issued automatically.\n");
 	logPrintf("\n");
 }
@@ -132,6 +133,7 @@ MPIUtil* mpiUtil = 0;
 bool mpiDebugLog = false;
 bool manualThreadCount = false;
 size_t mempoolSize = 0;
+size_t memcacheSize = size_t(128) << 20; //default: 128 MB (held in addition to live data, see Customization.dox)
 static double startTime_us; //Time at which system was initialized in microseconds
 const char* argv0 = 0;
 
@@ -215,12 +217,16 @@ void initSystem(int argc, char** argv)
 
 	//Print number of threads per process:
 	logPrintf("Maximum cpu threads by process:");
+	int coreOffset = 0; //number of cores used by preceding processes on this node (for thread pinning)
 	for(int jProcess=0; jProcess<mpiUtil->nProcesses(); jProcess++)
 	{	int nThreads = nProcsAvailable;
 		mpiUtil->bcast(nThreads, jProcess);
 		logPrintf(" %d", nThreads);
+		if(jProcess < mpiUtil->iProcess() && hostname[jProcess]==hostname[mpiUtil->iProcess()])
+			coreOffset += nThreads;
 	}
 	logPrintf("\n");
+	if(threadPinning) pinMainThread(coreOffset);
 	resumeOperatorThreading(); //if necessary, this informs MKL of the thread count
 	
 	//Print total resources used by run:
@@ -241,6 +247,21 @@ void initSystem(int argc, char** argv)
 			logPrintf("Could not determine memory pool size from JDFTX_MEMPOOL_SIZE=\"%s\".\n", mempoolSizeStr);
 	}
 	
+	//Memory reuse cache size:
+	const char* memcacheSizeStr = getenv("JDFTX_MEMCACHE_SIZE");
+	if(memcacheSizeStr)
+	{	int memcacheSizeMB;
+		if(sscanf(memcacheSizeStr, "%d", &memcacheSizeMB)==1 && memcacheSizeMB>=0)
+		{	memcacheSize = ((size_t)memcacheSizeMB) << 20; //convert to bytes
+			logPrintf("Memory reuse cache size: %d MB (per process)\n", memcacheSizeMB);
+		}
+		else
+			logPrintf("Could not determine memory reuse cache size from JDFTX_MEMCACHE_SIZE=\"%s\".\n", memcacheSizeStr);
+	}
+	
+	//Profiling:
+	StopWatch::initProfiling();
+	
 	//Add citations to the code for all calculations:
 	Citations::add("Software package",
 		"R. Sundararaman, K. Letchworth-Weaver, K.A. Schwarz, D. Gunceler, Y. Ozhabes and T.A. Arias, "
@@ -264,12 +285,13 @@ void initSystemCmdline(int argc, char** argv, const char* description, string& i
 			{"mpi-debug-log", no_argument, 0, 'm'},
 			{"dry-run", no_argument, 0, 'n'},
 			{"cores", required_argument, 0, 'c'},
+			{"pin-threads", no_argument, 0, 'p'},
 			{"skip-defaults", no_argument, 0, 's'},
 			{"write-manual", required_argument, 0, 'w'},
 			{0, 0, 0, 0}
 		};
 	while (1)
-	{	int c = getopt_long(argc, argv, "hvi:o:dtmnc:sw:", long_options, 0);
+	{	int c = getopt_long(argc, argv, "hvi:o:dtmnc:psw:", long_options, 0);
 		if (c == -1) break; //end of options
 		#define RUN_HEAD(code) if(mpiUtil->isHead()) { code } delete mpiUtil;
 		switch (c)
@@ -289,6 +311,7 @@ void initSystemCmdline(int argc, char** argv, const char* description, string& i
 				}
 				break;
 			}
+			case 'p': threadPinning=true; break;
 			case 's': printDefaults=false; break;
 			case 'w': RUN_HEAD( if(e) writeCommandManual(*e, optarg); ) exit(0);
 			default: RUN_HEAD( printUsage(argv[0], description); ) exit(1);
@@ -309,16 +332,6 @@ void initSystemCmdline(int argc, char** argv, const char* description, string& i
 	initSystem(argc, argv);
 }
 
-#ifdef ENABLE_PROFILING
-void stopWatchManager(const StopWatch* addWatch=0, const string* watchName=0)
-{	static std::multimap<string, const StopWatch*> watches; //static array of all watches
-	if(addWatch) watches.insert(std::make_pair(*watchName,addWatch));
-	else //print timings:
-	{	logPrintf("\n");
-		for(const auto& wPair: watches) wPair.second->print();
-	}
-}
-#endif // ENABLE_PROFILING
 
 
 void finalizeSystem(bool successful)
@@ -340,8 +353,8 @@ void finalizeSystem(bool successful)
 			fprintf(stderr, "Failed.\n");
 	}
 	
+	StopWatch::reportProfiling();
 	#ifdef ENABLE_PROFILING
-	stopWatchManager();
 	logPrintf("\n");
 	ManagedMemoryBase::reportUsage();
 	#endif
@@ -373,32 +386,6 @@ double clock_sec()
 }
 
 
-#ifdef ENABLE_PROFILING
-StopWatch::StopWatch(string name) : Ttot(0), TsqTot(0), nT(0), name(name) { stopWatchManager(this, &name); }
-void StopWatch::start()
-{
-	#ifdef GPU_ENABLED
-	cudaThreadSynchronize();
-	#endif
-	tPrev = clock_us();
-}
-void StopWatch::stop()
-{
-	#ifdef GPU_ENABLED
-	cudaThreadSynchronize();
-	#endif
-	double T = clock_us()-tPrev;
-	Ttot+=T; TsqTot+=T*T; nT++;
-}
-void StopWatch::print() const
-{	if(nT)
-	{	double meanT = Ttot/nT;
-		double sigmaT = sqrt(TsqTot/nT - meanT*meanT);
-		logPrintf("PROFILER: %30s %12.6lf +/- %12.6lf s, %4d calls, %13.6lf s total\n",
-			name.c_str(), meanT*1e-6, sigmaT*1e-6, nT, Ttot*1e-6);
-	}
-}
-#endif //ENABLE_PROFILING
 
 
 // Print a minimal stack trace (convenient for debugging)
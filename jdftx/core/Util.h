@@ -42,6 +42,7 @@ extern bool killFlag; //!< Flag set by signal handlers - all compute loops shoul
 extern MPIUtil* mpiUtil;
 extern bool mpiDebugLog; //!< If true, all processes output to seperate debug log files, otherwise only head process outputs (set before calling initSystem())
 extern size_t mempoolSize; //!< If non-zero, size of memory pool managed internally by JDFTx
+extern size_t memcacheSize; //!< Maximum bytes of freed buffers retained for reuse by ManagedMemory (0 disables reuse); set by JDFTX_MEMCACHE_SIZE in MB, default 128 MB
 void printVersionBanner(); //!< Print package name, version, revision etc. to log
 void initSystem(int argc, char** argv); //!< Init MPI (if not already done), print banner, set up threads (play nice with job schedulers), GPU and signal handlers
 void initSystemCmdline(int argc, char** argv, const char* description, string& inputFilename, bool& dryRun, bool& printDefaults, class Everything* e=0); //!< initSystem along with commandline options
@@ -68,29 +69,33 @@ Code must be self-contained as a scope, as it will be surrounded by { }, and sho
 //! Quick drop-in profiler for any function. Usage:
 //! * Create a static object of this class in the function
 //! * Call start and stop before and after the section to be timed
-//! * Timing statistics of the code block will be printed on exit
-#ifdef ENABLE_PROFILING
+//! * Timing statistics of the code block, nested within the enclosing timed sections
+//!   and resolved by thread and process, will be printed on exit
+//! Profiling is enabled at run time by the environment variable JDFTX_PROFILE (see initProfiling),
+//! and by default in builds with EnableProfiling. When disabled, start() and stop() only check a flag.
 class StopWatch
 {
 public:
-	StopWatch(string name);
-	void start();
-	void stop();
-	void print() const;
+	StopWatch(string name) : name(name) {}
+	void start() { if(profilingEnabled) startRegion(); }
+	void stop() { if(profilingEnabled) stopRegion(); }
+	const string& getName() const { return name; }
+	
+	static bool profilingEnabled; //!< whether timing data is being collected
+	static void initProfiling(); //!< enable profiling and select output based on JDFTX_PROFILE (called from initSystem)
+	static void reportProfiling(); //!< print profile to log and write requested output files (called from finalizeSystem on all processes)
 private:
-	double tPrev, Ttot, TsqTot; int nT;
 	string name;
+	void startRegion();
+	void stopRegion();
 };
-#else //ENABLE_PROFILING
-//Version which does no profiling for release versions
-class StopWatch
-{
-public:
-	StopWatch(string name) {}
-	void start() {}
-	void stop() {}
-};
-#endif //ENABLE_PROFILING
+
+//! Attribute floating-point operations and memory traffic (in bytes) to the innermost
+//! timed section of the current thread (does nothing when profiling is disabled)
+inline void profileCounts(double flops, double bytes)
+{	void profileCountsRegion(double flops, double bytes);
+	if(StopWatch::profilingEnabled) profileCountsRegion(flops, bytes);
+}
 
 
 
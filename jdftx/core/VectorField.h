@@ -278,7 +278,7 @@ namespace ScalarFieldMultipletPrivate
 
 	template<typename FuncOut, typename FuncIn, typename Out, typename In>
 	void threadUnary(FuncOut (*func)(FuncIn,int), int N, Out* out, In in)
-	{	int nThreadsTot = (isGpuEnabled() || !shouldThreadOperators()) ? 1 : nProcsAvailable;
+	{	int nThreadsTot = isGpuEnabled() ? 1 : operatorThreadCount();
 		int nOperatorThreads = std::min(nThreadsTot, N);
 		threadLaunch(nOperatorThreads, threadUnary_sub<FuncOut,FuncIn,Out,In>, 0, nThreadsTot, N, func, out, in);
 	}
@@ -25,7 +25,23 @@ BandDavidson::BandDavidson(Everything& e, int q): e(e), eVars(e.eVars), eInfo(e.
 {	assert(e.cntrl.fixed_H); // Check whether the electron Hamiltonian is fixed
 }
 
-void BandDavidson::minimize()
+//Concatenate columns of A and B (where A may be empty)
+static ColumnBundle appendColumns(const ColumnBundle& A, const ColumnBundle& B)
+{	if(!A.nCols()) return B;
+	ColumnBundle AB = A.similar(A.nCols()+B.nCols());
+	AB.setSub(0, A);
+	AB.setSub(A.nCols(), B);
+	return AB;
+}
+static matrix appendColumns(const matrix& A, const matrix& B)
+{	if(!A.nCols()) return B;
+	matrix AB(A.nRows(), A.nCols()+B.nCols());
+	AB.set(0,A.nRows(), 0,A.nCols(), A);
+	AB.set(0,A.nRows(), A.nCols(),AB.nCols(), B);
+	return AB;
+}
+
+void BandDavidson::minimize(FILE* fpLog)
 {	//Use the same working set as the CG minimizer:
 	ColumnBundle& C = eVars.C[q];
 	std::vector<matrix>& VdagC = eVars.VdagC[q];
@@ -33,8 +49,17 @@ void BandDavidson::minimize()
 	matrix& Hsub_evecs = eVars.Hsub_evecs[q];
 	diagMatrix& Hsub_eigs = eVars.Hsub_eigs[q];
 	const QuantumNumber& qnum = eInfo.qnums[q];
+	const MinimizeParams& mp = e.elecMinParams;
 	int nBandsOut = eInfo.nBands; //number of final output bands desired
 	int nBandsMax = ceil(e.cntrl.davidsonBandRatio * nBandsOut);
+	//Block mode: expand only a block of the lowest unconverged bands each iteration,
+	//lock converged bands out of the working set, and let the subspace grow between restarts:
+	int blockSize = e.cntrl.davidsonBlockSize;
+	bool blockMode = (blockSize > 0);
+	int nBandsRestart = blockMode ? nBandsMax + 2*blockSize : nBandsMax; //subspace size beyond which it is compressed to nBandsMax
+	int nIterationsMax = blockMode ? mp.nIterations * ceildiv(nBandsOut, blockSize) : mp.nIterations; //same number of H applications as full mode
+	ColumnBundle Clocked; std::vector<matrix> VdagClocked(VdagC.size()); diagMatrix eigsLocked; //locked (converged) eigenpairs
+	int nLocked = 0;
 	
 	//Initial subspace eigenvalue problem:
 	ColumnBundle HC;
@@ -48,38 +73,70 @@ void BandDavidson::minimize()
 	HC = HC * Hsub_evecs;
 	e.iInfo.project(C, VdagC, &Hsub_evecs);
 	double Eband = qnum.weight * trace(Hsub_eigs);
-	logPrintf("BandDavidson: Iter: %3d  Eband: %+.15lf\n", 0, Eband); fflush(globalLog);
+	fprintf(fpLog, "BandDavidson: Iter: %3d  Eband: %+.15lf\n", 0, Eband); fflush(fpLog);
 	
-	const MinimizeParams& mp = e.elecMinParams;
 	int iter=1;
-	for(; iter<=mp.nIterations; iter++)
-	{	int nBands = C.nCols();
+	for(; iter<=nIterationsMax; iter++)
+	{	int nBands = C.nCols(); //working set excluding locked bands
+		int nActive = blockMode ? std::min(blockSize, nBandsOut-nLocked) : nBands; //bands whose residuals expand the subspace
 		//Compute subspace expansion:
-		diagMatrix KEref = (-0.5) * diagDot(C, L(C)); //Update reference KE for preconditioning:
-		ColumnBundle Cexp = HC; Cexp -= O(C) * Hsub_eigs; //Calculate residual of current eigenvector guesses
+		ColumnBundle Cexp; diagMatrix KEref;
+		if(nActive == nBands)
+		{	KEref = (-0.5) * diagDot(C, L(C)); //Update reference KE for preconditioning:
+			Cexp = HC; Cexp -= O(C) * Hsub_eigs; //Calculate residual of current eigenvector guesses
+		}
+		else
+		{	ColumnBundle Cactive = C.getSub(0, nActive);
+			KEref = (-0.5) * diagDot(Cactive, L(Cactive));
+			Cexp = HC.getSub(0, nActive); Cexp -= O(Cactive) * Hsub_eigs(0, nActive);
+		}
 		precond_inv_kinetic_band(Cexp, KEref); //Davidson approximate inverse (using KE as the diagonal)
 		//Drop converged eigenpairs and approximately normalize subspace expansion (for avoiding roundoff issues only):
 		diagMatrix CexpNorm = diagDot(Cexp, Cexp);
-		double CexpNormCut = std::max(mp.energyDiffThreshold/nBands, 1e-15*Cexp.colLength());
+		double CexpNormCut = std::max(mp.energyDiffThreshold/(blockMode ? nBandsOut : nBands), 1e-15*Cexp.colLength());
+		int nNewlyLocked = 0;
+		if(blockMode) //lock bands that have converged contiguously from the bottom of the working set
+		{	while(nNewlyLocked<nActive && CexpNorm[nNewlyLocked]<CexpNormCut) nNewlyLocked++;
+			if(nLocked + nNewlyLocked == nBandsOut)
+			{	fprintf(fpLog, "BandDavidson: Converged (all %d bands locked)\n", nBandsOut);
+				break;
+			}
+			if(nNewlyLocked) //move newly converged bands out of the working set
+			{	Clocked = appendColumns(Clocked, C.getSub(0, nNewlyLocked));
+				C = C.getSub(nNewlyLocked, nBands);
+				HC = HC.getSub(nNewlyLocked, nBands);
+				for(size_t sp=0; sp<VdagC.size(); sp++) if(VdagC[sp])
+				{	int nProj = VdagC[sp].nRows();
+					VdagClocked[sp] = appendColumns(VdagClocked[sp], VdagC[sp](0,nProj, 0,nNewlyLocked));
+					VdagC[sp] = VdagC[sp](0,nProj, nNewlyLocked,nBands);
+				}
+				eigsLocked.insert(eigsLocked.end(), Hsub_eigs.begin(), Hsub_eigs.begin()+nNewlyLocked);
+				Hsub_eigs = Hsub_eigs(nNewlyLocked, nBands);
+				nLocked += nNewlyLocked;
+				nBands -= nNewlyLocked;
+			}
+		}
 		{	//Drop columns whose norm falls below above cutoff
 			complex* CexpData = Cexp.dataPref();
 			int bOut = 0;
-			for(int b=0; b<nBands; b++)
+			for(int b=0; b<nActive; b++)
 			{	if(CexpNorm[b]<CexpNormCut) continue;
 				CexpNorm[bOut] = 1/sqrt(CexpNorm[b]);
 				if(bOut<b) callPref(eblas_copy)(CexpData+Cexp.index(bOut,0), CexpData+Cexp.index(b,0), Cexp.colLength());
 				bOut++;
 			}
+			if(!bOut && blockMode) continue; //all active bands locked: proceed to next block
 			if(!bOut) //This is unlikely, but just in case (to avoid zero column matrices below)
-			{	logPrintf("BandDavidson: Converged (dEband<%le)\n", mp.energyDiffThreshold);
+			{	fprintf(fpLog, "BandDavidson: Converged (dEband<%le)\n", mp.energyDiffThreshold);
 				break;
 			}
-			if(bOut<nBands)
+			if(bOut<nActive)
 			{	Cexp = Cexp.getSub(0,bOut);
 				CexpNorm = CexpNorm(0,bOut);
 			}
 		}
 		Cexp = Cexp * CexpNorm;
+		if(nLocked) Cexp -= Clocked * (Clocked ^ O(Cexp)); //orthogonalize expansion to locked bands
 		int nBandsNew = Cexp.nCols();
 		int nBandsBig = nBands + nBandsNew;
 		//Expansion subspace overlaps:
@@ -118,7 +175,9 @@ void BandDavidson::minimize()
 		matrix bigHsub_evecs; diagMatrix bigHsub_eigs;
 		bigHsub.diagonalize(bigHsub_evecs, bigHsub_eigs);
 		matrix rot = bigU * bigHsub_evecs; //rotation from [C,Cexp] to the expanded subspace eigenbasis
-		int nBandsNext = std::min(nBandsMax, nBandsBig); //number of bands to retain for next iteration
+		int nBandsNext = std::min(nBandsMax, nBandsBig+nLocked) - nLocked; //number of bands to retain for next iteration
+		if(blockMode && nBandsBig+nLocked <= nBandsRestart)
+			nBandsNext = nBandsBig; //retain entire subspace until it needs to be compressed
 		matrix Crot = rot(0,nBands, 0,nBandsNext); //contribution of C to lowest nBandsNext eigenvectors
 		matrix CexpRot = rot(nBands,nBandsBig, 0,nBandsNext); //contribution of Cexp to lowest nBandsNext eigenvectors
 		//Update C to optimum nBands subspace from [C,Cexp]
@@ -129,19 +188,28 @@ void BandDavidson::minimize()
 			VdagC[sp] = VdagC[sp]*Crot + VdagCexp[sp]*CexpRot;
 		//Print and test convergence
 		double EbandPrev = Eband;
-		Eband = qnum.weight * trace(Hsub_eigs(0,nBandsOut));
+		Eband = qnum.weight * (trace(eigsLocked) + trace(Hsub_eigs(0,nBandsOut-nLocked)));
 		double dEband = Eband - EbandPrev;
-		logPrintf("BandDavidson: Iter: %3d  Eband: %+.15lf  dEband: %le\n", iter, Eband, dEband); fflush(globalLog);
-		if(dEband<0 and fabs(dEband)<mp.energyDiffThreshold)
-		{	logPrintf("BandDavidson: Converged (dEband<%le)\n", mp.energyDiffThreshold);
+		fprintf(fpLog, "BandDavidson: Iter: %3d  Eband: %+.15lf  dEband: %le", iter, Eband, dEband);
+		if(blockMode) fprintf(fpLog, "  nLocked: %d", nLocked);
+		fprintf(fpLog, "\n"); fflush(fpLog);
+		if(!blockMode and dEband<0 and fabs(dEband)<mp.energyDiffThreshold) //block mode converges by locking instead
+		{	fprintf(fpLog, "BandDavidson: Converged (dEband<%le)\n", mp.energyDiffThreshold);
 			break;
 		}
 	}
-	if(iter>mp.nIterations)
-		logPrintf("BandDavidson: None of the convergence criteria satisfied after %d iterations.\n", mp.nIterations);
-	fflush(globalLog);
+	if(iter>nIterationsMax)
+		fprintf(fpLog, "BandDavidson: None of the convergence criteria satisfied after %d iterations.\n", nIterationsMax);
+	fflush(fpLog);
 	
 	//Update final quantities:
+	if(nLocked) //restore locked bands to the front of the working set
+	{	C = appendColumns(Clocked, C.getSub(0, nBandsOut-nLocked));
+		for(size_t sp=0; sp<VdagC.size(); sp++) if(VdagC[sp])
+			VdagC[sp] = appendColumns(VdagClocked[sp], VdagC[sp](0,VdagC[sp].nRows(), 0,nBandsOut-nLocked));
+		eigsLocked.insert(eigsLocked.end(), Hsub_eigs.begin(), Hsub_eigs.begin()+(nBandsOut-nLocked));
+		Hsub_eigs = eigsLocked;
+	}
 	if(C.nCols() != nBandsOut)
 	{	//reduce outputs to size:
 		C = C.getSub(0, nBandsOut);
@@ -23,7 +23,6 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 BandMinimizer::BandMinimizer(Everything& e, int q): e(e), eVars(e.eVars), eInfo(e.eInfo), q(q)
 {	assert(e.cntrl.fixed_H); // Check whether the electron Hamiltonian is fixed
-	e.elecMinParams.energyLabel = relevantFreeEnergyName(e);
 }
 
 void BandMinimizer::step(const ColumnBundle& dir, double alpha)
@@ -37,7 +36,8 @@ double BandMinimizer::compute(ColumnBundle* grad, ColumnBundle* Kgrad)
 	diagMatrix Fq = eye(eInfo.nBands);
 	const QuantumNumber& qnum = eInfo.qnums[q];
 	ColumnBundle Hq;
-	double KEq = eVars.applyHamiltonian(q, Fq, Hq, e.ener, true);
+	Energies ener; //not really used here (and kept local since quantum numbers may be solved concurrently)
+	double KEq = eVars.applyHamiltonian(q, Fq, Hq, ener, true);
 	if(grad)
 	{	double KErollover = 2.*KEq/(qnum.weight*eInfo.nBands);
 		Hq -=  O(eVars.C[q])*eVars.Hsub[q]; //orthonormality contribution
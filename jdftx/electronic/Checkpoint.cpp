@@ -0,0 +1,212 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/Checkpoint.h>
+#include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
+#include <cstdio>
+
+Checkpoint::Checkpoint() : interval(0), filenamePattern("checkpoint.$VAR"), iterPending(-1), writer(0), writeDone(true), writeFailed(false)
+{
+}
+
+Checkpoint::~Checkpoint()
+{	if(writer) //can no longer commit (MPI may be finalized), but make sure the thread does not outlive its data
+	{	writer->join();
+		delete writer;
+	}
+}
+
+string Checkpoint::getFilename(string varName) const
+{	string fname = filenamePattern;
+	size_t pos = fname.find("$VAR");
+	if(pos != string::npos) fname.replace(pos,4, varName);
+	return fname;
+}
+
+void Checkpoint::addSegment(const string& fname, long offset, const void* data, size_t nBytes)
+{	Segment seg;
+	seg.fname = fname;
+	seg.offset = offset;
+	seg.data.assign((const char*)data, (const char*)data + nBytes);
+	segments.push_back(seg);
+}
+
+//Capture output written by a FILE*-based writer into a memory buffer:
+inline std::vector<char> captureOutput(std::function<void(FILE*)> writeFunc)
+{	char* buf = 0; size_t bufSize = 0;
+	FILE* fp = open_memstream(&buf, &bufSize);
+	if(!fp) die("Could not create memory stream for checkpoint.\n");
+	writeFunc(fp);
+	fclose(fp);
+	std::vector<char> result(buf, buf+bufSize);
+	free(buf);
+	return result;
+}
+
+void Checkpoint::save(const Everything& e, int iter, std::function<void(FILE*)> writeHistory)
+{	if(interval<=0 || iter<=0 || iter%interval) return; //nothing to save before the first iteration
+	static StopWatch watch("Checkpoint::save"); watch.start();
+
+	//Commit previous checkpoint if complete on all processes, otherwise skip this one:
+	if(iterPending >= 0)
+	{	bool allDone = writeDone;
+		mpiUtil->allReduce(allDone, MPIUtil::ReduceLAnd);
+		if(!allDone)
+		{	logPrintf("Checkpoint: previous write (iteration %d) in progress; skipping iteration %d.\n", iterPending, iter);
+			watch.stop();
+			return;
+		}
+		commit();
+	}
+
+	//Snapshot state:
+	const ElecInfo& eInfo = e.eInfo;
+	const ElecVars& eVars = e.eVars;
+	segments.clear();
+	fnames.clear();
+	//--- wavefunctions (same layout as write(std::vector<ColumnBundle>...)):
+	{	string fname = getFilename("wfns"); fnames.push_back(fname);
+		std::vector<long> nBytes(mpiUtil->nProcesses(), 0);
+		for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+			nBytes[mpiUtil->iProcess()] += eVars.C[q].nData()*sizeof(complex);
+		mpiUtil->allReduce(nBytes.data(), nBytes.size(), MPIUtil::ReduceSum);
+		long offset = 0;
+		for(int iSrc=0; iSrc<mpiUtil->iProcess(); iSrc++) offset += nBytes[iSrc];
+		for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+		{	size_t nBytesQ = eVars.C[q].nData()*sizeof(complex);
+			addSegment(fname, offset, eVars.C[q].data(), nBytesQ);
+			offset += nBytesQ;
+		}
+	}
+	//--- fillings (external normalization, as in Dump) and eigenvalues (to initialize the auxiliary Hamiltonian):
+	if(eInfo.fillingsUpdate==ElecInfo::FillingsHsub)
+	{	string fname = getFilename("fillings"); fnames.push_back(fname);
+		double wInv = eInfo.spinType==SpinNone ? 0.5 : 1.0; //normalization factor from external to internal fillings
+		for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+		{	diagMatrix Fq = eVars.F[q] * (1./wInv);
+			addSegment(fname, q*eInfo.nBands*sizeof(double), Fq.data(), eInfo.nBands*sizeof(double));
+		}
+		fname = getFilename("eigenvals"); fnames.push_back(fname);
+		for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+			addSegment(fname, q*eInfo.nBands*sizeof(double), eVars.Hsub_eigs[q].data(), eInfo.nBands*sizeof(double));
+	}
+	//--- SCF history:
+	if(writeHistory)
+	{	string fname = getFilename("scfHistory"); fnames.push_back(fname);
+		if(mpiUtil->isHead())
+		{	Segment seg; seg.fname = fname; seg.offset = 0;
+			seg.data = captureOutput(writeHistory);
+			segments.push_back(seg);
+		}
+	}
+	//--- lattice vectors (same format as Dump, so that it can be included in the input file):
+	{	string fname = getFilename("lattice"); fnames.push_back(fname);
+		if(mpiUtil->isHead())
+		{	Segment seg; seg.fname = fname; seg.offset = 0;
+			seg.data = captureOutput([&](FILE* fp)
+			{	fprintf(fp, "lattice");
+				for(int j=0; j<3; j++)
+				{	fprintf(fp, " \\\n\t");
+					for(int k=0; k<3; k++)
+						fprintf(fp, "%20.15lf ", e.gInfo.R(j,k));
+				}
+				fprintf(fp, "#Note: latt-scale has been absorbed into these lattice vectors.\n");
+			});
+			segments.push_back(seg);
+		}
+	}
+	//--- ionic positions (collective call, for magnetic moments):
+	{	string fname = getFilename("ionpos"); fnames.push_back(fname);
+		auto writePositions = [&](FILE* fp)
+		{	fprintf(fp, "# Checkpoint at electronic iteration %d\n", iter);
+			e.iInfo.printPositions(fp);
+		};
+		if(mpiUtil->isHead())
+		{	Segment seg; seg.fname = fname; seg.offset = 0;
+			seg.data = captureOutput(writePositions);
+			segments.push_back(seg);
+		}
+		else writePositions(nullLog);
+	}
+
+	//Create (truncate) temporary files before any process writes to them:
+	bool createFailed = false;
+	if(mpiUtil->isHead())
+		for(const string& fname: fnames)
+		{	FILE* fp = fopen((fname+".tmp").c_str(), "w");
+			if(!fp || fclose(fp))
+			{	logPrintf("Checkpoint: WARNING could not create '%s.tmp'; skipping iteration %d.\n", fname.c_str(), iter);
+				createFailed = true;
+				break;
+			}
+		}
+	mpiUtil->bcast(createFailed); //also ensures the files exist before any process writes to them
+	if(createFailed)
+	{	segments.clear();
+		watch.stop();
+		return;
+	}
+
+	//Write in background:
+	iterPending = iter;
+	writeDone = false;
+	writeFailed = false;
+	writer = new std::thread(&Checkpoint::writeSegments, this);
+	logPrintf("Checkpoint: writing state at iteration %d in background.\n", iter); logFlush();
+	watch.stop();
+}
+
+void Checkpoint::writeSegments()
+{	for(const Segment& seg: segments)
+	{	FILE* fp = fopen((seg.fname+".tmp").c_str(), "r+b");
+		if(!fp) { writeFailed = true; break; }
+		bool ok = (fseek(fp, seg.offset, SEEK_SET) == 0)
+			&& (fwrite(seg.data.data(), 1, seg.data.size(), fp) == seg.data.size())
+			&& (fflush(fp) == 0);
+		if(fclose(fp) || !ok) { writeFailed = true; break; } //errors (eg. disk full) may only surface on flush / close
+	}
+	writeDone = true;
+}
+
+void Checkpoint::commit()
+{	if(writer)
+	{	writer->join();
+		delete writer;
+		writer = 0;
+	}
+	bool anyFailed = writeFailed;
+	mpiUtil->allReduce(anyFailed, MPIUtil::ReduceLOr); //also waits for all processes to complete their writes
+	if(anyFailed)
+		logPrintf("Checkpoint: WARNING writing state from iteration %d failed; previous checkpoint (if any) retained.\n", iterPending);
+	else
+	{	if(mpiUtil->isHead())
+			for(const string& fname: fnames)
+				if(rename((fname+".tmp").c_str(), fname.c_str()))
+					logPrintf("Checkpoint: WARNING could not rename '%s.tmp' to '%s'.\n", fname.c_str(), fname.c_str());
+		logPrintf("Checkpoint: committed state from iteration %d to '%s'.\n", iterPending, filenamePattern.c_str());
+	}
+	logFlush();
+	iterPending = -1;
+	segments.clear();
+}
+
+void Checkpoint::finish()
+{	if(iterPending >= 0) commit();
+}
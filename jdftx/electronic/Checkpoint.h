@@ -0,0 +1,76 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_ELECTRONIC_CHECKPOINT_H
+#define JDFTX_ELECTRONIC_CHECKPOINT_H
+
+#include <core/Util.h>
+#include <functional>
+#include <thread>
+#include <atomic>
+
+class Everything;
+
+//! @addtogroup Output
+//! @{
+//! @file Checkpoint.h Periodic asynchronous checkpointing of the electronic state
+
+//! Periodically snapshots the state required to restart a calculation (wavefunctions, fillings,
+//! eigenvalues, SCF history, lattice vectors and ionic positions) and writes it out on a background thread.
+//! The files are written with temporary names and renamed only once all processes complete,
+//! so that the last committed checkpoint is always consistent and readable with initial-state.
+class Checkpoint
+{
+public:
+	int interval; //!< checkpoint every so many electronic iterations (0 => disabled)
+	string filenamePattern; //!< output filename pattern containing $VAR
+
+	Checkpoint();
+	~Checkpoint();
+
+	//! Checkpoint the current state if iter (>0) is a multiple of interval (must be called from all processes).
+	//! Optionally, writeHistory is invoked on the head process to serialize SCF mixing history.
+	//! If the previous checkpoint is still being written, this one is skipped rather than stalling the calculation.
+	void save(const Everything& e, int iter, std::function<void(FILE*)> writeHistory=nullptr);
+
+	//! Wait for any pending write and commit it (must be called from all processes before exit)
+	void finish();
+
+private:
+	//! Contiguous block of data to be written to a file at a given offset
+	struct Segment
+	{	string fname; //!< final filename (written to a temporary file first)
+		long offset; //!< byte offset within file
+		std::vector<char> data; //!< snapshot of the data
+	};
+	std::vector<Segment> segments; //!< snapshot currently being written (separate from the live state, so computation proceeds)
+	std::vector<string> fnames; //!< files in current snapshot (committed on head)
+	int iterPending; //!< iteration number of the pending checkpoint (-1 if none)
+	std::thread* writer; //!< background writer thread
+	std::atomic<bool> writeDone; //!< whether the background write has completed on this process
+	std::atomic<bool> writeFailed; //!< whether any open / write / flush failed in the background write on this process
+
+	string getFilename(string varName) const;
+	void addSegment(const string& fname, long offset, const void* data, size_t nBytes);
+	void commit(); //!< wait for current write and rename temporary files to final names (unless the write failed on any process)
+	void writeSegments(); //!< body of writer thread
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_CHECKPOINT_H
@@ -158,24 +158,107 @@ matrix operator^(const scaled<ColumnBundle> &sY1, const scaled<ColumnBundle> &sY
 
 //------------------------------ Other operators ---------------------------------
 
+//In-place transform of nTransforms contiguous full-grid arrays using batched plans where possible (CPU only)
+void batchTransform(const GridInfo& gInfo, bool inverse, int nTransforms, complex* data)
+{	const int nBatch = GridInfo::nFFTbatch;
+	gInfo.profileFFT(nTransforms);
+	int i = 0;
+	if(nTransforms >= nBatch)
+	{	fftw_plan plan = gInfo.getPlan(inverse ? GridInfo::PlanInverseBatch : GridInfo::PlanForwardBatch, 1);
+		for(; i+nBatch<=nTransforms; i+=nBatch)
+			fftw_execute_dft(plan, (fftw_complex*)(data+i*gInfo.nr), (fftw_complex*)(data+i*gInfo.nr));
+	}
+	if(i < nTransforms) //remainder that does not fill a batch
+	{	fftw_plan plan = gInfo.getPlan(inverse ? GridInfo::PlanInverseInPlace : GridInfo::PlanForwardInPlace, 1);
+		for(; i<nTransforms; i++)
+			fftw_execute_dft(plan, (fftw_complex*)(data+i*gInfo.nr), (fftw_complex*)(data+i*gInfo.nr));
+	}
+}
+
+//Scatter all spinor components of columns colStart to colStop-1 of C to full G-space and transform them to real space in work
+//(column col, spinor component s ends up at work + ((col-colStart)*nSpinor + s)*nr)
+void batchIcolumns(const ColumnBundle& C, int colStart, int colStop, complex* work)
+{	const Basis& basis = *(C.basis);
+	size_t nr = basis.gInfo->nr;
+	int nSpinor = C.spinorLength();
+	int nTransforms = (colStop-colStart)*nSpinor;
+	eblas_zero(nTransforms*nr, work);
+	for(int col=colStart; col<colStop; col++)
+		for(int s=0; s<nSpinor; s++)
+			eblas_scatter_zdaxpy(basis.nbasis, 1., basis.index.data(), C.data()+C.index(col,s*basis.nbasis), work+((col-colStart)*nSpinor+s)*nr);
+	batchTransform(*basis.gInfo, true, nTransforms, work);
+}
+
+//Number of columns to process together in the batched CPU routines below
+inline int batchColumns(int nSpinor) { return std::max(1, GridInfo::nFFTbatch/nSpinor); }
+
 void Idag_DiagV_I_sub(int colStart, int colEnd, const ColumnBundle* C, const ScalarFieldArray* V, ColumnBundle* VC)
 {	const ScalarField& Vs = V->at(V->size()==1 ? 0 : C->qnum->index());
 	int nSpinor = VC->spinorLength();
-	for(int col=colStart; col<colEnd; col++)
-		for(int s=0; s<nSpinor; s++)
-			VC->accumColumn(col,s, Idag(Vs * I(C->getColumn(col,s)))); //note VC is zero'd just before
+	if(isGpuEnabled())
+	{	for(int col=colStart; col<colEnd; col++)
+			for(int s=0; s<nSpinor; s++)
+				VC->accumColumn(col,s, Idag(Vs * I(C->getColumn(col,s)))); //note VC is zero'd just before
+		return;
+	}
+	//Batched CPU version with a single work buffer reused for all columns in this range:
+	const Basis& basis = *(C->basis);
+	size_t nr = basis.gInfo->nr;
+	const double* Vdata = Vs->data();
+	int nColsBatch = batchColumns(nSpinor);
+	ManagedArray<complex> work; work.init(nColsBatch*nSpinor*nr);
+	for(int colBatch=colStart; colBatch<colEnd; colBatch+=nColsBatch)
+	{	int colBatchStop = std::min(colBatch+nColsBatch, colEnd);
+		int nTransforms = (colBatchStop-colBatch)*nSpinor;
+		batchIcolumns(*C, colBatch, colBatchStop, work.data());
+		for(int i=0; i<nTransforms; i++)
+			eblas_zmuld(nr, Vdata, 1, work.data()+i*nr, 1);
+		batchTransform(*basis.gInfo, false, nTransforms, work.data());
+		for(int col=colBatch; col<colBatchStop; col++)
+			for(int s=0; s<nSpinor; s++)
+				eblas_gather_zdaxpy(basis.nbasis, 1., basis.index.data(), work.data()+((col-colBatch)*nSpinor+s)*nr, VC->data()+VC->index(col,s*basis.nbasis));
+	}
 }
 
 //Noncollinear version of above (with the preprocessing of complex off-diagonal potentials done in calling function)
 void Idag_DiagVmat_I_sub(int colStart, int colEnd, const ColumnBundle* C, const ScalarField* Vup, const ScalarField* Vdn,
 	const complexScalarField* VupDn, const complexScalarField* VdnUp, ColumnBundle* VC)
-{	for(int col=colStart; col<colEnd; col++)
-	{	complexScalarField ICup = I(C->getColumn(col,0));
-		complexScalarField ICdn = I(C->getColumn(col,1));
-		VC->accumColumn(col,0, Idag((*Vup)*ICup + (*VupDn)*ICdn));
-		VC->accumColumn(col,1, Idag((*Vdn)*ICdn + (*VdnUp)*ICup));
+{	if(isGpuEnabled())
+	{	for(int col=colStart; col<colEnd; col++)
+		{	complexScalarField ICup = I(C->getColumn(col,0));
+			complexScalarField ICdn = I(C->getColumn(col,1));
+			VC->accumColumn(col,0, Idag((*Vup)*ICup + (*VupDn)*ICdn));
+			VC->accumColumn(col,1, Idag((*Vdn)*ICdn + (*VdnUp)*ICup));
+		}
+		return;
+	}
+	//Batched CPU version with a single work buffer reused for all columns in this range:
+	const Basis& basis = *(C->basis);
+	size_t nr = basis.gInfo->nr;
+	const double* VupData = (*Vup)->data();
+	const double* VdnData = (*Vdn)->data();
+	const complex* VupDnData = (*VupDn)->data();
+	const complex* VdnUpData = (*VdnUp)->data();
+	int nColsBatch = batchColumns(2);
+	ManagedArray<complex> work; work.init(nColsBatch*2*nr);
+	for(int colBatch=colStart; colBatch<colEnd; colBatch+=nColsBatch)
+	{	int colBatchStop = std::min(colBatch+nColsBatch, colEnd);
+		int nTransforms = (colBatchStop-colBatch)*2;
+		batchIcolumns(*C, colBatch, colBatchStop, work.data());
+		for(int col=colBatch; col<colBatchStop; col++)
+		{	complex* psiUp = work.data() + (col-colBatch)*2*nr;
+			complex* psiDn = psiUp + nr;
+			for(size_t i=0; i<nr; i++)
+			{	complex up = psiUp[i], dn = psiDn[i];
+				psiUp[i] = VupData[i]*up + VupDnData[i]*dn;
+				psiDn[i] = VdnData[i]*dn + VdnUpData[i]*up;
+			}
+		}
+		batchTransform(*basis.gInfo, false, nTransforms, work.data());
+		for(int col=colBatch; col<colBatchStop; col++)
+			for(int s=0; s<2; s++)
+				eblas_gather_zdaxpy(basis.nbasis, 1., basis.index.data(), work.data()+((col-colBatch)*2+s)*nr, VC->data()+VC->index(col,s*basis.nbasis));
 	}
-	
 }
 
 ColumnBundle Idag_DiagV_I(const ColumnBundle& C, const ScalarFieldArray& V)
@@ -429,9 +512,32 @@ void diagouterI_sub(int iThread, int nThreads, const diagMatrix *F, const Column
 	ScalarFieldArray& nLocal = (*nSub)[iThread];
 	nullToZero(nLocal, *(X->basis->gInfo)); //sets to zero
 	int nDensities = nLocal.size();
+	int nSpinor = X->spinorLength();
+	if(!isGpuEnabled())
+	{	//Batched CPU version with a single work buffer reused for all columns in this range:
+		size_t nr = X->basis->gInfo->nr;
+		int nColsBatch = batchColumns(nSpinor);
+		ManagedArray<complex> work; work.init(nColsBatch*nSpinor*nr);
+		for(int colBatch=colStart; colBatch<colStop; colBatch+=nColsBatch)
+		{	int colBatchStop = std::min(colBatch+nColsBatch, colStop);
+			batchIcolumns(*X, colBatch, colBatchStop, work.data());
+			for(int i=colBatch; i<colBatchStop; i++)
+			{	const complex* psi = work.data() + (i-colBatch)*nSpinor*nr;
+				if(nDensities==1)
+				{	for(int s=0; s<nSpinor; s++)
+						eblas_accumNorm(nr, (*F)[i], psi+s*nr, nLocal[0]->data());
+				}
+				else //nDensities==4
+				{	eblas_accumNorm(nr, (*F)[i], psi, nLocal[0]->data()); //UpUp
+					eblas_accumNorm(nr, (*F)[i], psi+nr, nLocal[1]->data()); //DnDn
+					eblas_accumProd(nr, (*F)[i], psi, psi+nr, nLocal[2]->data(), nLocal[3]->data()); //Re and Im parts of UpDn
+				}
+			}
+		}
+		return;
+	}
 	if(nDensities==1) //Note that nDensities==2 below will also enter this branch sinc eonly one component is non-zero
-	{	int nSpinor = X->spinorLength();
-		for(int i=colStart; i<colStop; i++)
+	{	for(int i=colStart; i<colStop; i++)
 			for(int s=0; s<nSpinor; s++)
 				callPref(eblas_accumNorm)(X->basis->gInfo->nr, (*F)[i], I(X->getColumn(i,s))->dataPref(), nLocal[0]->dataPref());
 	}
@@ -472,7 +578,7 @@ ScalarFieldArray diagouterI(const diagMatrix &F,const ColumnBundle &X,  int nDen
 	if(nDensities==4) assert(X.isSpinor());
 	
 	//Collect the contributions for different sets of columns in separate scalar fields (one per thread):
-	int nThreads = isGpuEnabled() ? 1: nProcsAvailable;
+	int nThreads = isGpuEnabled() ? 1: operatorThreadCount();
 	std::vector<ScalarFieldArray> nSub(nThreads, ScalarFieldArray(nDensities==2 ? 1 : nDensities)); //collinear spin-polarized will have only one non-zero output channel
 	threadLaunch(nThreads, diagouterI_sub, 0, &F, &X, &nSub);
 
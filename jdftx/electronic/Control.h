@@ -40,7 +40,11 @@ class Control
 public:
 	bool fixed_H; //!< fixed Hamiltonian (band structure) mode for electronic sector
 	bool cacheProjectors; //!< whether to cache nonlocal projectors
+	bool realSpaceProjectors; //!< whether to apply nonlocal projectors in real space (truncated to spheres around atoms)
+	double realSpaceProjectorTol; //!< fraction of projector norm that may be truncated in real-space mode
 	double davidsonBandRatio; //!< ratio of number of Davidson working bands to actual bands in system (>= 1)
+	int davidsonBlockSize; //!< number of lowest unconverged bands expanded per Davidson iteration, with locking of converged bands (0 => all bands)
+	int bandMinimizeThreads; //!< number of threads solving quantum numbers concurrently in fixed-Hamiltonian minimization (0 => automatic, only for band structures)
 	
 	ElecEigenAlgo elecEigenAlgo; //!< Eigenvalue algorithm
 	BasisKdep basisKdep; //!< k-dependence of basis
@@ -64,13 +68,17 @@ public:
 	bool convergeEmptyStates; //!< whether to converge empty states after every electronic minimization
 	bool dumpOnly; //!< run a single-electronic-point energy evaluation and process the end dump
 	
+	bool exxACE; //!< whether to use the adaptively compressed exchange (ACE) operator for hybrid functionals
+	int exxACEnOuter; //!< maximum number of ACE updates (outer loops) in total-energy minimization
+	
 	Control()
 	:	fixed_H(false),
-		cacheProjectors(true), davidsonBandRatio(1.1),
+		cacheProjectors(true), realSpaceProjectors(false), realSpaceProjectorTol(1e-6), davidsonBandRatio(1.1), davidsonBlockSize(0), bandMinimizeThreads(0),
 		elecEigenAlgo(ElecEigenDavidson), basisKdep(BasisKpointDep), Ecut(0), EcutRho(0), dragWavefunctions(true),
 		fluidGummel_nIterations(10), fluidGummel_Atol(1e-5),
 		shouldPrintEigsFillings(false), shouldPrintEcomponents(false), shouldPrintMuSearch(false), shouldPrintKpointsBasis(false),
-		subspaceRotationFactor(1.), subspaceRotationAdjust(true), scf(false), convergeEmptyStates(false), dumpOnly(false)
+		subspaceRotationFactor(1.), subspaceRotationAdjust(true), scf(false), convergeEmptyStates(false), dumpOnly(false),
+		exxACE(false), exxACEnOuter(20)
 	{
 	}
 };
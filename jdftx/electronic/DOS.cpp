@@ -25,7 +25,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/LatticeUtils.h>
 #include <array>
 
-DOS::DOS() : Etol(1e-6), Esigma(0)
+DOS::DOS() : Etol(1e-6), Esigma(0), weightBatch(0)
 {
 }
 
@@ -238,20 +238,69 @@ struct EvalDOS
 	std::vector<Tetrahedron> tetrahedra;
 	
 	int nWeights, nStates, nBands; double Etol, Esigma;
+	int nWeightsTot, iWeightStart; //total number of weight functions, and start of the batch of nWeights currently being processed
 	std::vector<double> eigs; //flat array of eigenvalues (inner index state, outer index bands)
-	std::vector<double> weights; //flat array of DOS weights (inner index weight function, middle index state, and outer index bands)
+	std::vector<double> weights; //flat array of DOS weights (inner index weight function, middle index state, and outer index bands) for the locally stored states and bands
+	int wStateStart, wStateCount, wBandStart; //range of states and start of bands stored in weights (local states and all bands initially, all states and bandRange() after distributeWeights())
 	double& e(int iState, int iBand) { return eigs[iState + nStates*iBand]; } //access eigenvalue
 	const double& e(int iState, int iBand) const { return eigs[iState + nStates*iBand]; } //access eigenvalue (const version)
-	double& w(int iWeight, int iState, int iBand) { return weights[iWeight + nWeights*(iState + nStates*iBand)]; } //access weight
-	const double& w(int iWeight, int iState, int iBand) const { return weights[iWeight + nWeights*(iState + nStates*iBand)]; } //access weight (const version)
+	double& w(int iWeight, int iState, int iBand) { return weights[iWeight + nWeightsTot*((iState-wStateStart) + wStateCount*(iBand-wBandStart))]; } //access weight
+	const double& w(int iWeight, int iState, int iBand) const { return weights[iWeight + nWeightsTot*((iState-wStateStart) + wStateCount*(iBand-wBandStart))]; } //access weight (const version)
 	
-	EvalDOS(int nCells, int nWeights, int nStates, int nBands, double Etol, double Esigma)
+	//Initially allocate weights only for the states [qStart,qStop) of the current process:
+	EvalDOS(int nCells, int nWeights, int nStates, int nBands, double Etol, double Esigma, int qStart, int qStop)
 	: tetrahedra(nCells),
 	nWeights(nWeights), nStates(nStates), nBands(nBands), Etol(Etol), Esigma(Esigma),
-	eigs(nStates*nBands), weights(nWeights*nStates*nBands)
+	nWeightsTot(nWeights), iWeightStart(0),
+	eigs(nStates*nBands), weights(nWeights*(qStop-qStart)*nBands),
+	wStateStart(qStart), wStateCount(qStop-qStart), wBandStart(0)
 	{
 	}
 	
+	//Range of bands whose DOS contributions are computed by process iProc:
+	void bandRange(int iProc, int& bStart, int& bStop) const
+	{	int nProcesses = mpiUtil->nProcesses();
+		bStart = (nBands * iProc) / nProcesses;
+		bStop = (nBands * (iProc+1)) / nProcesses;
+	}
+	
+	//Redistribute weights from the states of each process (all bands) to all states of the bands of each process (see bandRange),
+	//so that each process only ever stores its share of the weights (rather than all weights for all states and bands).
+	//Processes take turns as the source in the same order on all processes, so that the blocking sends and receives match up.
+	void distributeWeights(const ElecInfo& eInfo)
+	{	if(mpiUtil->nProcesses()==1) return; //already contains all states and bands
+		int iProc = mpiUtil->iProcess();
+		int bStart, bStop; bandRange(iProc, bStart, bStop);
+		std::vector<double> weightsMine(nWeightsTot*nStates*(bStop-bStart));
+		std::vector<double> buf;
+		for(int iSrc=0; iSrc<mpiUtil->nProcesses(); iSrc++)
+		{	int qStartSrc = eInfo.qStartOther(iSrc), nStatesSrc = eInfo.qStopOther(iSrc) - qStartSrc;
+			size_t blockSize = nWeightsTot*nStatesSrc; //contiguous weights of all states of iSrc for one band
+			const double* bandData; //weights of iSrc for bands [bStart,bStop) of this process
+			if(iSrc == iProc)
+			{	//Send each other process only the slice of its bands:
+				for(int iDest=0; iDest<mpiUtil->nProcesses(); iDest++)
+					if(iDest != iProc)
+					{	int bStartDest, bStopDest; bandRange(iDest, bStartDest, bStopDest);
+						mpiUtil->send(weights.data()+bStartDest*blockSize, (bStopDest-bStartDest)*blockSize, iDest, iSrc);
+					}
+				bandData = weights.data() + bStart*blockSize;
+			}
+			else
+			{	buf.resize((bStop-bStart)*blockSize);
+				mpiUtil->recv(buf.data(), buf.size(), iSrc, iSrc);
+				bandData = buf.data();
+			}
+			for(int iBand=bStart; iBand<bStop; iBand++)
+				std::copy(bandData+(iBand-bStart)*blockSize, bandData+(iBand-bStart+1)*blockSize,
+					weightsMine.begin() + nWeightsTot*(qStartSrc + nStates*(iBand-bStart)));
+		}
+		std::swap(weights, weightsMine);
+		wStateStart = 0;
+		wStateCount = nStates;
+		wBandStart = bStart;
+	}
+	
 	//Replace clusters of eigenvalues that differ by less than Etol, to a single value
 	void weldEigenvalues()
 	{	std::multimap<double,size_t> eigMap;
@@ -316,6 +365,23 @@ struct EvalDOS
 
 	struct Cspline : public std::map<Interval,CsplineElem> //array of piecewise cubic splines (one for each weight function)
 	{	std::map<double, std::vector<double> > deltas; //additional delta functions (from tetrahedra with same energy for all vertices)
+		
+		//Add the (uncoalesced) pieces from another spline accumulated over a different set of tetrahedra:
+		void accumulate(const Cspline& other, int nWeights)
+		{	for(const auto& iter: other)
+			{	CsplineElem& c = (*this)[iter.first];
+				if(!c.bArr.size()) { c.bArr = iter.second.bArr; continue; }
+				for(int i=0; i<nWeights; i++)
+					for(int k=0; k<4; k++)
+						c.bArr[i][k] += iter.second.bArr[i][k];
+			}
+			for(const auto& iter: other.deltas)
+			{	std::vector<double>& wDelta = deltas[iter.first];
+				if(!wDelta.size()) { wDelta = iter.second; continue; }
+				for(int i=0; i<nWeights; i++)
+					wDelta[i] += iter.second[i];
+			}
+		}
 	};
 	
 	//Accumulate contribution from one tetrahedron (exactly a cubic spline for linear interpolation)
@@ -327,7 +393,7 @@ struct EvalDOS
 		{	const EvalDOS& eval; int iBand, stateOffset;
 			EnergyCmp(const EvalDOS& eval, int iBand, int stateOffset) : eval(eval), iBand(iBand), stateOffset(stateOffset) {}
 			const double& e(int q) { return eval.e(stateOffset+q, iBand); }
-			const double* w(int q) { return &eval.w(0, stateOffset+q, iBand); }
+			const double* w(int q) { return &eval.w(eval.iWeightStart, stateOffset+q, iBand); }
 			bool operator()(int q1, int q2) { return e(q1)<e(q2); }
 		};
 		EnergyCmp eCmp(*this, iBand, stateOffset); //accessor object and functor to sort vertices by energy
@@ -595,35 +661,140 @@ struct EvalDOS
 		return out;
 	}
 	
-	//Generate the density of states for a given state offset:
+	//Convert the accumulated cubic splines of a single band to a linear spline:
+	Lspline bandLspline(Cspline& wdos) const
+	{	Lspline lspline;
+		if(wdos.size()==0 && wdos.deltas.size()==1) // band is a single delta function
+		{	double eDelta = wdos.deltas.begin()->first;
+			const std::vector<double>& wDelta = wdos.deltas.begin()->second;
+			lspline.resize(3, std::make_pair(eDelta, std::vector<double>(nWeights, 0.)));
+			lspline[0].first = eDelta-0.5*Etol;
+			lspline[2].first = eDelta+0.5*Etol;
+			for(int i=0; i<nWeights; i++)
+				lspline[1].second[i] = wDelta[i] * (2./Etol);
+		}
+		else
+		{	coalesceIntervals(wdos);
+			lspline = convertLspline(wdos);
+		}
+		return lspline;
+	}
+	
+	//Thread function accumulating blocks of tetrahedra for each band into separate partial splines (indexed by block, then band):
+	static void accumBlocks_thread(size_t iStart, size_t iStop, const EvalDOS* eval, int stateOffset, int bStart, int nBlocks, std::vector<Cspline>* partial)
+	{	size_t nTetrahedra = eval->tetrahedra.size();
+		for(size_t iPartial=iStart; iPartial<iStop; iPartial++)
+		{	int iBand = bStart + iPartial/nBlocks;
+			int iBlock = iPartial % nBlocks;
+			size_t tStart = (iBlock * nTetrahedra) / nBlocks;
+			size_t tStop = ((iBlock+1) * nTetrahedra) / nBlocks;
+			for(size_t t=tStart; t<tStop; t++)
+				eval->accumTetrahedron(eval->tetrahedra[t], iBand, stateOffset, partial->at(iPartial));
+		}
+	}
+	
+	//Thread function merging the partial splines of each band and converting them to linear splines:
+	static void bandLsplines_thread(size_t iStart, size_t iStop, const EvalDOS* eval, int bStart, int nBlocks, std::vector<Cspline>* partial, std::vector<Lspline>* lsplines)
+	{	for(size_t iBandMine=iStart; iBandMine<iStop; iBandMine++)
+		{	Cspline& wdos = partial->at(iBandMine*nBlocks);
+			for(int iBlock=1; iBlock<nBlocks; iBlock++)
+			{	Cspline& wdosBlock = partial->at(iBandMine*nBlocks + iBlock);
+				wdos.accumulate(wdosBlock, eval->nWeights);
+				wdosBlock.clear(); wdosBlock.deltas.clear(); //free memory
+			}
+			lsplines->at(bStart+iBandMine) = eval->bandLspline(wdos);
+		}
+	}
+	
+	//Send / receive the linear spline of a band between processes:
+	void sendLspline(const Lspline& lspline, int dest) const
+	{	int nNodes = lspline.size();
+		mpiUtil->send(nNodes, dest, 0);
+		std::vector<double> message; message.reserve(nNodes*(nWeights+1));
+		for(const LsplineElem& elem: lspline)
+		{	message.push_back(elem.first);
+			message.insert(message.end(), elem.second.begin(), elem.second.end());
+		}
+		mpiUtil->send(message.data(), message.size(), dest, 0);
+	}
+	void recvLspline(Lspline& lspline, int src) const
+	{	int nNodes = 0;
+		mpiUtil->recv(nNodes, src, 0);
+		std::vector<double> message(nNodes*(nWeights+1));
+		mpiUtil->recv(message.data(), message.size(), src, 0);
+		lspline.assign(nNodes, std::make_pair(0., std::vector<double>(nWeights)));
+		const double* messagePtr = message.data();
+		for(LsplineElem& elem: lspline)
+		{	elem.first = *(messagePtr++);
+			for(double& wi: elem.second) wi = *(messagePtr++);
+		}
+	}
+	
+	//Generate the density of states for a given state offset (for the current batch of weight functions).
+	//Bands are divided between processes, and tetrahedra in blocks of each band between threads.
+	//Must be called from all processes; the result is returned on the head process alone (empty elsewhere).
 	Lspline getDOS(int stateOffset) const
-	{	std::vector<Lspline> lsplines(nBands);
-		for(int iBand=0; iBand<nBands; iBand++)
-		{	Cspline wdos;
-			for(const Tetrahedron& t: tetrahedra)
-				accumTetrahedron(t, iBand, stateOffset, wdos);
-			if(wdos.size()==0 && wdos.deltas.size()==1) // band is a single delta function
-			{	double eDelta = wdos.deltas.begin()->first;
-				const std::vector<double>& wDelta = wdos.deltas.begin()->second;
-				lsplines[iBand].resize(3, std::make_pair(eDelta, std::vector<double>(nWeights, 0.)));
-				lsplines[iBand][0].first = eDelta-0.5*Etol;
-				lsplines[iBand][2].first = eDelta+0.5*Etol;
-				for(int i=0; i<nWeights; i++)
-					lsplines[iBand][1].second[i] = wDelta[i] * (2./Etol);
+	{	static StopWatch watch("EvalDOS::getDOS"); watch.start();
+		int nProcesses = mpiUtil->nProcesses();
+		int bStart, bStop; bandRange(mpiUtil->iProcess(), bStart, bStop);
+		int nBandsMine = bStop - bStart;
+		//Accumulate tetrahedra (split each band into enough blocks to occupy all threads):
+		int nBlocks = std::min(ceildiv(2*nProcsAvailable, std::max(nBandsMine,1)), std::max(int(tetrahedra.size()),1));
+		std::vector<Cspline> partial(nBandsMine*nBlocks);
+		std::vector<Lspline> lsplines(nBands);
+		if(nBandsMine)
+		{	threadLaunch(accumBlocks_thread, partial.size(), this, stateOffset, bStart, nBlocks, &partial);
+			//Merge blocks and convert to linear splines for each band:
+			threadLaunch(bandLsplines_thread, nBandsMine, this, bStart, nBlocks, &partial, &lsplines);
+			partial.clear();
+		}
+		//Collect linear splines of all bands on head:
+		if(nProcesses > 1)
+		{	if(mpiUtil->isHead())
+			{	for(int iSrc=1; iSrc<nProcesses; iSrc++)
+				{	int bStartSrc, bStopSrc; bandRange(iSrc, bStartSrc, bStopSrc);
+					for(int iBand=bStartSrc; iBand<bStopSrc; iBand++)
+						recvLspline(lsplines[iBand], iSrc);
+				}
 			}
 			else
-			{	coalesceIntervals(wdos);
-				lsplines[iBand] = convertLspline(wdos);
+			{	for(int iBand=bStart; iBand<bStop; iBand++)
+					sendLspline(lsplines[iBand], 0);
+				watch.stop();
+				return Lspline();
 			}
 		}
-		return gaussSmooth(mergeLsplines(lsplines));
+		Lspline result = gaussSmooth(mergeLsplines(lsplines));
+		watch.stop();
+		return result;
 	}
 	
-	//Write the density of states to a file, for a given state offset:
-	void printDOS(int stateOffset, string filename, string header)
+	//Write the density of states to a file, for a given state offset (must be called from all processes).
+	//The weight functions are processed in batches of at most weightBatch (all at once if zero), reusing the welded eigenvalues;
+	//the energy nodes depend only on the eigenvalues, so that each batch yields additional columns on the same nodes.
+	void printDOS(int stateOffset, string filename, string header, int weightBatch)
 	{	logPrintf("Dumping '%s' ... ", filename.c_str()); logFlush();
 		//Compute DOS:
-		Lspline wdos = getDOS(stateOffset);
+		int batchSize = (weightBatch>0 ? std::min(weightBatch, nWeightsTot) : nWeightsTot);
+		Lspline wdos;
+		for(iWeightStart=0; iWeightStart<nWeightsTot; iWeightStart+=batchSize)
+		{	nWeights = std::min(batchSize, nWeightsTot-iWeightStart);
+			Lspline wdosBatch = getDOS(stateOffset);
+			if(!mpiUtil->isHead()) continue;
+			if(!iWeightStart) //initialize nodes
+			{	wdos.resize(wdosBatch.size());
+				for(size_t j=0; j<wdos.size(); j++)
+				{	wdos[j].first = wdosBatch[j].first;
+					wdos[j].second.resize(nWeightsTot);
+				}
+			}
+			assert(wdos.size() == wdosBatch.size());
+			for(size_t j=0; j<wdos.size(); j++)
+				std::copy(wdosBatch[j].second.begin(), wdosBatch[j].second.end(), wdos[j].second.begin()+iWeightStart);
+		}
+		iWeightStart = 0;
+		nWeights = nWeightsTot;
+		if(!mpiUtil->isHead()) return;
 		//Output DOS:
 		FILE* fp = fopen(filename.c_str(), "w");
 		if(!fp) die("Could not open '%s' for writing.\n", filename.c_str());
@@ -739,7 +910,7 @@ void DOS::dump()
 			kpointMap[round((vector3<>(kRange[s0][0],kRange[s1][1],kRange[s2][2])-kmesh[0])*supercell.super, symmThreshold)] = i;
 	}
 	//--- add 6 tetrahedra per parallelopiped cell
-	EvalDOS eval(6*kmesh.size(), weights.size(), eInfo.nStates, eInfo.nBands, Etol, Esigma);
+	EvalDOS eval(6*kmesh.size(), weights.size(), eInfo.nStates, eInfo.nBands, Etol, Esigma, eInfo.qStart, eInfo.qStop);
 	double Vtot = 0.;
 	for(unsigned i=0; i<kmesh.size(); i++)
 	{	const vector3<>& v0 = kmesh[i];
@@ -967,43 +1138,16 @@ void DOS::dump()
 			eval.e(iState, iBand) = e->eVars.Hsub_eigs[iState][iBand];
 		}
 		
-	//Synchronize eigenvalues and weights between processes:
-	if(mpiUtil->nProcesses()>1)
-	{	if(mpiUtil->isHead())
-		{	for(int iSrc=1; iSrc<mpiUtil->nProcesses(); iSrc++)
-			{	int qStart = eInfo.qStartOther(iSrc);
-				int qStop = eInfo.qStopOther(iSrc);
-				std::vector<double> message((qStop-qStart)*eInfo.nBands*(weights.size()+1));
-				mpiUtil->recv(message.data(), message.size(), iSrc, 0);
-				const double* messagePtr = message.data();
-				for(int iState=qStart; iState<qStop; iState++)
-					for(int iBand=0; iBand<eInfo.nBands; iBand++)
-					{	for(unsigned iWeight=0; iWeight<weights.size(); iWeight++)
-							eval.w(iWeight, iState, iBand) = *(messagePtr++);
-						eval.e(iState, iBand) = *(messagePtr++);
-					}
-			}
-		}
-		else
-		{	//Pack data into a single message:
-			std::vector<double> message((eInfo.qStop-eInfo.qStart)*eInfo.nBands*(weights.size()+1));
-			double* messagePtr = message.data();
-			for(int iState=eInfo.qStart; iState<eInfo.qStop; iState++)
-				for(int iBand=0; iBand<eInfo.nBands; iBand++)
-				{	for(unsigned iWeight=0; iWeight<weights.size(); iWeight++)
-						*(messagePtr++) = eval.w(iWeight, iState, iBand);
-					*(messagePtr++) = eval.e(iState, iBand);
-				}
-			mpiUtil->send(message.data(), message.size(), 0, 0);
-		}
-	}
-	if(!mpiUtil->isHead()) return;
+	//Synchronize eigenvalues (each state is set on exactly one process, and zero on others; needed in full for welding),
+	//and redistribute weights by band (each process only stores weights for the bands it integrates):
+	mpiUtil->allReduce(eval.eigs.data(), eval.eigs.size(), MPIUtil::ReduceSum);
+	eval.distributeWeights(eInfo);
 	
-	//Compute and print density of states (head only):
+	//Compute and print density of states (in parallel, output from head):
 	string header = "\"Energy\"";
 	for(const Weight& weight: weights)
 		header += ("\t\"" + weight.getDescription(*e) + "\"");
 	eval.weldEigenvalues();
 	for(int iSpin=0; iSpin<nSpins; iSpin++)
-		eval.printDOS(iSpin*qCount, e->dump.getFilename(nSpins==1 ? "dos" : (iSpin==0 ? "dosUp" : "dosDn")), header);
+		eval.printDOS(iSpin*qCount, e->dump.getFilename(nSpins==1 ? "dos" : (iSpin==0 ? "dosUp" : "dosDn")), header, weightBatch);
 }
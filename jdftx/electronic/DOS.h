@@ -84,6 +84,7 @@ public:
 	std::vector<Weight> weights; //!< list of weight functions (default: total DOS only)
 	double Etol; //!< tolerance for identifying eigenvalues (energy resolution) (default: 1e-6)
 	double Esigma; //!< optional gaussian width in spectrum
+	int weightBatch; //!< maximum number of weight functions processed together (default: 0 => all at once)
 	
 	DOS();
 	void setup(const Everything&); //!< initialize
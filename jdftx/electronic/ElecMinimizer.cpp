@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/ColumnBundle.h>
 #include <electronic/Everything.h>
 #include <electronic/Dump.h>
+#include <electronic/ExactExchange.h>
 #include <fluid/FluidSolver.h>
 #include <core/Random.h>
 #include <core/ScalarField.h>
@@ -245,6 +246,7 @@ bool ElecMinimizer::report(int iter)
 	
 	//Dump:
 	e.dump(DumpFreq_Electronic, iter);
+	e.checkpoint.save(e, iter);
 	
 	//Re-unitarize rotations:
 	if(rotExists)
@@ -270,18 +272,67 @@ double ElecMinimizer::sync(double x) const
 	return x;
 }
 
+//Minimize a single quantum number with fixed Hamiltonian, logging iterations to fpLog
+void bandMinimize(Everything& e, int q, FILE* fpLog)
+{	fprintf(fpLog, "\n---- Minimization of quantum number: "); e.eInfo.kpointPrint(fpLog, q, true); fprintf(fpLog, " ----\n");
+	switch(e.cntrl.elecEigenAlgo)
+	{	case ElecEigenCG:
+		{	MinimizeParams mp = e.elecMinParams;
+			mp.fpLog = fpLog;
+			BandMinimizer(e, q).minimize(mp);
+			break;
+		}
+		case ElecEigenDavidson: { BandDavidson(e, q).minimize(fpLog); break; }
+	}
+}
+
+//Minimize quantum numbers qOrder[i] in order of i, handing out the next one to whichever thread is free.
+//The log of each solve is buffered and printed once that solve completes, so that concurrent logs do not interleave.
+//Errors are flagged in failed and reported by the launching thread, after which the remaining threads stop picking up work.
+void bandMinimize_thread(int iThread, int nThreads, Everything* e, const std::vector<int>* qOrder, std::atomic<int>* iNext, std::mutex* logLock, std::atomic<bool>* failed)
+{	for(int i=(*iNext)++; i<int(qOrder->size()) && !(*failed); i=(*iNext)++)
+	{	char* buf = 0; size_t bufSize = 0;
+		FILE* fpLog = open_memstream(&buf, &bufSize);
+		if(!fpLog) { *failed = true; return; }
+		bandMinimize(*e, qOrder->at(i), fpLog);
+		fclose(fpLog);
+		logLock->lock();
+		fwrite(buf, 1, bufSize, globalLog); fflush(globalLog);
+		logLock->unlock();
+		free(buf);
+	}
+}
+
 void bandMinimize(Everything& e)
 {	bool fixed_H = true; std::swap(fixed_H, e.cntrl.fixed_H); //remember fixed_H flag and temporarily set it to true
 	logPrintf("Minimization will be done independently for each quantum number.\n");
+	e.elecMinParams.energyLabel = relevantFreeEnergyName(e);
+	//Determine number of quantum numbers to solve concurrently:
+	int nStates = e.eInfo.qStop - e.eInfo.qStart;
+	int nGroups = e.cntrl.bandMinimizeThreads;
+	if(!nGroups) //automatic: only for band structure calculations (not SCF), and only when all cores can be kept busy
+		nGroups = (fixed_H && nStates >= nProcsAvailable) ? nProcsAvailable : 1;
+	nGroups = std::min(nGroups, std::min(nStates, nProcsAvailable));
+	if(isGpuEnabled()) nGroups = 1; //GPU operators should only be called from a single thread
+	if(nGroups > 1)
+	{	//Solve on single threads (operators within are not threaded), starting with the largest bases for load balancing:
+		logPrintf("Solving %d quantum numbers concurrently on %d threads.\n", nStates, nGroups); logFlush();
+		std::vector<int> qOrder(nStates);
+		for(int i=0; i<nStates; i++) qOrder[i] = e.eInfo.qStart + i;
+		std::stable_sort(qOrder.begin(), qOrder.end(), [&](int q1, int q2) { return e.basis[q1].nbasis > e.basis[q2].nbasis; });
+		std::atomic<int> iNext(0);
+		std::mutex logLock;
+		std::atomic<bool> failed(false);
+		threadLaunch(nGroups, bandMinimize_thread, 0, &e, &qOrder, &iNext, &logLock, &failed);
+		if(failed) die("Could not create memory stream for band minimization log.\n");
+	}
+	else
+	{	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+			bandMinimize(e, q, globalLog);
+	}
 	e.ener.Eband = 0.;
 	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
-	{	logPrintf("\n---- Minimization of quantum number: "); e.eInfo.kpointPrint(globalLog, q, true); logPrintf(" ----\n");
-		switch(e.cntrl.elecEigenAlgo)
-		{	case ElecEigenCG: { BandMinimizer(e, q).minimize(e.elecMinParams); break; }
-			case ElecEigenDavidson: { BandDavidson(e, q).minimize(); break; }
-		}
 		e.ener.Eband += e.eInfo.qnums[q].weight * trace(e.eVars.Hsub_eigs[q]);
-	}
 	mpiUtil->allReduce(e.ener.Eband, MPIUtil::ReduceSum);
 	if(e.cntrl.shouldPrintEigsFillings)
 	{	//Print the eigenvalues if requested
@@ -357,6 +408,29 @@ void elecMinimize(Everything& e)
 	else if(e.cntrl.fixed_H)
 	{	bandMinimize(e);
 	}
+	else if(e.exCorr.exxFactor() && e.cntrl.exxACE)
+	{	//Hybrid functional using ACE: minimize with the compressed exchange operator held fixed,
+		//and update the operator in an outer loop until the exact exchange energy converges
+		ElecMinimizer emin(e);
+		double aXX = e.exCorr.exxFactor();
+		double omega = e.exCorr.exxRange();
+		double EXXprev = NAN;
+		for(int iOuter=0; iOuter<e.cntrl.exxACEnOuter; iOuter++)
+		{	double EXX = e.exx->prepareACE(aXX, omega, e.eVars.F, e.eVars.C);
+			logPrintf("\nACE outer iteration %d: EXX = %.15lf", iOuter+1, EXX);
+			if(!std::isnan(EXXprev)) logPrintf("  |dEXX| = %le", fabs(EXX-EXXprev));
+			logPrintf("\n"); logFlush();
+			if(fabs(EXX-EXXprev) < e.elecMinParams.energyDiffThreshold)
+			{	logPrintf("ACE outer loop converged.\n");
+				break;
+			}
+			EXXprev = EXX;
+			e.exx->freezeACE = true;
+			emin.minimize(e.elecMinParams);
+			e.exx->freezeACE = false;
+		}
+		if (!e.ionDynamicsParams.tMax) e.eVars.setEigenvectors(); //Don't spend time with this if running MD
+	}
 	else
 	{	ElecMinimizer emin(e);
 		emin.minimize(e.elecMinParams);
@@ -401,7 +401,11 @@ double ElecVars::elecEnergyAndGrad(Energies& ener, ElecGradient* grad, ElecGradi
 	{	double aXX = e->exCorr.exxFactor();
 		double omega = e->exCorr.exxRange();
 		assert(e->exx);
-		ener.E["EXX"] = (*e->exx)(aXX, omega, F, C, need_Hsub ? &HC : 0);
+		if(e->cntrl.exxACE)
+		{	//Compressed exchange operator, applied along with the rest of the Hamiltonian below:
+			if(!(e->exx->freezeACE && e->exx->hasACE())) e->exx->prepareACE(aXX, omega, F, C); //rebuild at current wavefunctions
+		}
+		else ener.E["EXX"] = (*e->exx)(aXX, omega, F, C, need_Hsub ? &HC : 0);
 	}
 	
 	//Do the single-particle contributions one state at a time to save memory (and for better cache warmth):
@@ -421,8 +425,13 @@ double ElecVars::elecEnergyAndGrad(Energies& ener, ElecGradient* grad, ElecGradi
 			}
 		}
 	}
-	mpiUtil->allReduce(ener.E["KE"], MPIUtil::ReduceSum);
-	mpiUtil->allReduce(ener.E["Enl"], MPIUtil::ReduceSum);
+	bool aceActive = e->exx && e->exx->hasACE() && e->cntrl.exxACE;
+	double Esum[3] = { ener.E["KE"], ener.E["Enl"], aceActive ? ener.E["EXX"] : 0. };
+	mpiUtil->allReduce(Esum, 3, MPIUtil::ReduceSum); //single reduction for all state-summed energies
+	ener.E["KE"] = Esum[0];
+	ener.E["Enl"] = Esum[1];
+	if(aceActive) //Correct the ACE expectation value (which double counts) to the exact exchange energy at the ACE construction point:
+		ener.E["EXX"] = Esum[2] - e->exx->getEXXace();
 	
 	double dmuContrib = 0., dBzContrib = 0.;
 	if(grad and eInfo.fillingsUpdate==ElecInfo::FillingsHsub and (std::isnan(eInfo.mu) or eInfo.Mconstrain)) //contribution due to N/M constraint via the mu/Bz gradient 
@@ -548,10 +557,14 @@ ScalarFieldArray ElecVars::KEdensity() const
 	for(int q=e->eInfo.qStart; q<e->eInfo.qStop; q++)
 		for(int iDir=0; iDir<3; iDir++)
 			tau += (0.5*C[q].qnum->weight) * diagouterI(F[q], D(C[q],iDir), tau.size(), &e->gInfo);
-	for(ScalarField& tau_s: tau)
-	{	nullToZero(tau_s, e->gInfo);
-		e->symm.symmetrize(tau_s); //Symmetrize
-		tau_s->allReduce(MPIUtil::ReduceSum);
+	std::vector<MPIUtil::Request> requests(tau.size());
+	for(unsigned s=0; s<tau.size(); s++)
+	{	nullToZero(tau[s], e->gInfo);
+		requests[s] = tau[s]->allReduceAsync(MPIUtil::ReduceSum);
+	}
+	for(unsigned s=0; s<tau.size(); s++)
+	{	mpiUtil->wait(requests[s]); //symmetrize each channel while the later ones are still being reduced
+		e->symm.symmetrize(tau[s]);
 	}
 	//Add core KE density model:
 	if(e->iInfo.tauCore)
@@ -563,18 +576,43 @@ ScalarFieldArray ElecVars::KEdensity() const
 
 ScalarFieldArray ElecVars::calcDensity() const
 {	ScalarFieldArray density(n.size());
+	const ElecInfo& eInfo = e->eInfo;
+	//Find the last local state contributing to each spin channel (collinear spin-polarized states contribute to one channel each):
+	std::vector<int> qLast(density.size(), eInfo.qStop-1);
+	if(density.size()==2)
+		for(int s=0; s<2; s++)
+		{	qLast[s] = eInfo.qStart-1;
+			for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+				if(eInfo.qnums[q].index()==s) qLast[s] = q;
+		}
+	//Reduction of each channel is started as soon as its local contributions are complete, to overlap with remaining states:
+	//(not possible with ultrasoft pseudopotentials, since grid augmentation requires all states)
+	bool pipeline = !e->iInfo.hasAugmentation();
+	std::vector<MPIUtil::Request> requests(density.size());
+	std::vector<bool> started(density.size(), false);
+	auto startReduce = [&](int s)
+	{	nullToZero(density[s], e->gInfo);
+		requests[s] = density[s]->allReduceAsync(MPIUtil::ReduceSum);
+		started[s] = true;
+	};
+	
 	//Runs over all states and accumulates density to the corresponding spin channel of the total density
 	e->iInfo.augmentDensityInit();
-	for(int q=e->eInfo.qStart; q<e->eInfo.qStop; q++)
-	{	density += e->eInfo.qnums[q].weight * diagouterI(F[q], C[q], density.size(), &e->gInfo);
-		e->iInfo.augmentDensitySpherical(e->eInfo.qnums[q], F[q], VdagC[q]); //pseudopotential contribution
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	density += eInfo.qnums[q].weight * diagouterI(F[q], C[q], density.size(), &e->gInfo);
+		e->iInfo.augmentDensitySpherical(eInfo.qnums[q], F[q], VdagC[q]); //pseudopotential contribution
+		if(pipeline)
+			for(unsigned s=0; s<density.size(); s++)
+				if(qLast[s]==q) startReduce(s);
 	}
 	e->iInfo.augmentDensityGrid(density);
+	for(unsigned s=0; s<density.size(); s++)
+		if(!started[s]) startReduce(s);
 	
-	for(ScalarField& ns: density)
-	{	nullToZero(ns, e->gInfo);
-		e->symm.symmetrize(ns); //Symmetrize
-		ns->allReduce(MPIUtil::ReduceSum);
+	//Complete reductions and symmetrize (after reduction, which commutes with it):
+	for(unsigned s=0; s<density.size(); s++)
+	{	mpiUtil->wait(requests[s]);
+		e->symm.symmetrize(density[s]);
 	}
 	return density;
 }
@@ -604,6 +642,10 @@ double ElecVars::applyHamiltonian(int q, const diagMatrix& Fq, ColumnBundle& HCq
 		if(e->eInfo.hasU) //Contribution via atomic density matrix projections (DFT+U)
 			e->iInfo.rhoAtom_grad(C[q], U_rhoAtom, HCq);
 	}
+	
+	//Exact exchange using the compressed (ACE) operator, if available:
+	if(e->exx && e->exx->hasACE() && e->cntrl.exxACE)
+		ener.E["EXX"] += e->exx->applyACE(q, Fq, C[q], need_Hsub ? &HCq : 0);
 
 	//Kinetic energy:
 	double KEq;
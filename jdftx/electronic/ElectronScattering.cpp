@@ -40,8 +40,18 @@ matrix imag(const matrix& m)
 	return out;
 }
 
+//Calculate diag(dagger(A)*B) without constructing large intermediate matrix
+diagMatrix diaginner(const matrix& A, const matrix& B)
+{	assert(A.nRows()==B.nRows());
+	assert(A.nCols()==B.nCols());
+	diagMatrix result(A.nCols());
+	for(int col=0; col<A.nCols(); col++)
+		result[col] = callPref(eblas_zdotc)(A.nRows(), A.dataPref()+A.index(0,col),1, B.dataPref()+B.index(0,col),1).real();
+	return result;
+}
+
 ElectronScattering::ElectronScattering()
-: eta(0.), Ecut(0.), fCut(1e-6), omegaMax(0.), slabResponse(false), EcutTransverse(0.)
+: eta(0.), Ecut(0.), fCut(1e-6), omegaMax(0.), slabResponse(false), EcutTransverse(0.), cacheMemory(1024.)
 {
 }
 
@@ -235,6 +245,16 @@ void ElectronScattering::dump(const Everything& everything)
 		}
 	}
 	logPrintf("done.\n"); logFlush();
+	
+	//Divide memory for real-space wavefunctions between states of the first and second k-points of events:
+	{	size_t nkMine = ikStop-ikStart;
+		double entryMemory = nBands * nSpinor * e.gInfo.nr * sizeof(complex); //upper bound on bytes per k-point
+		size_t nEntries = size_t(std::max(0., cacheMemory * 1024*1024 / entryMemory));
+		cacheJ.capacity = std::min(nkMine, nEntries/2);
+		cacheI.capacity = std::min(nkMine, nEntries - cacheJ.capacity);
+		logPrintf("Caching real-space wavefunctions for %lu of %lu k-points per momentum transfer on this process.\n",
+			cacheI.capacity+cacheJ.capacity, 2*nkMine);
+	}
 
 	//Main loop over momentum transfers:
 	diagMatrix ImKscrHead(omegaGrid.size(), 0.);
@@ -243,6 +263,7 @@ void ElectronScattering::dump(const Everything& everything)
 	{	logPrintf("\nMomentum transfer %d of %d: q = ", int(iq+1), int(qmesh.size()));
 		qmesh[iq].k.print(globalLog, " %+.5lf ");
 		int nbasis = basisChi[iq].nbasis;
+		cacheJ.entries.clear(); //second states of events are different for each q
 		
 		//Construct Coulomb operator (regularizes G=0 using the tricks developed for EXX):
 		matrix invKq = inv(coulombMatrix(iq));
@@ -327,7 +348,7 @@ void ElectronScattering::dump(const Everything& everything)
 				for(const Event& event: events)
 					delta.push_back(e.gInfo.detR * event.fWeight //overlap and sign for electron / hole
 						* (2*eta/M_PI) * ( 1./(event.Eji - omegaTilde).norm() - 1./(event.Eji + omegaTilde).norm()) ); //Normalized Lorentzians
-				eventContrib += wOmega[iOmega] * delta * diag(dagger(nij) * ImKscr[iOmega] * nij);
+				eventContrib += wOmega[iOmega] * delta * diaginner(nij, ImKscr[iOmega] * nij); //only diagonal of dagger(nij)*ImKscr*nij needed
 			}
 			//Accumulate contributions to linewidth:
 			int iReduced = supercell->kmeshTransform[ik].iReduced; //directly collect to reduced k-point
@@ -341,6 +362,10 @@ void ElectronScattering::dump(const Everything& everything)
 		logPrintf("done.\n"); logFlush();
 	}
 	logPrintf("\n");
+	cacheI.entries.clear();
+	cacheJ.entries.clear();
+	logPrintf("Real-space wavefunction cache hits: %lu of %lu (first states), %lu of %lu (second states)\n",
+		cacheI.nHits, cacheI.nHits+cacheI.nMisses, cacheJ.nHits, cacheJ.nHits+cacheJ.nMisses);
 	
 	ImKscrHead.allReduce(MPIUtil::ReduceSum);
 	for(diagMatrix& IS: ImSigma)
@@ -428,39 +453,87 @@ std::vector<ElectronScattering::Event> ElectronScattering::getEvents(bool chiMod
 	if(!events.size()) return events;
 	
 	//Get wavefunctions in real space:
-	ColumnBundle Ci, Cj; if(!slabResponse) { Ci = getWfns(ik, ki); Cj = getWfns(jk, kj); }
-	std::vector< std::vector<complexScalarField> > conjICi(nBands), ICj(nBands);
 	watchI.start();
-	for(int i=0; i<nBands; i++) if(iUsed[i])
-	{	conjICi[i].resize(nSpinor);
-		for(int s=0; s<nSpinor; s++)
-			conjICi[i][s] = conj(I((slabResponse ? C[ik] : Ci).getColumn(i,s))); 
+	std::shared_ptr<RealSpaceWfns> ICi, ICj;
+	if(slabResponse) //same state for both (zero momentum transfer), and each state is needed only once
+	{	std::vector<bool> used(nBands);
+		for(int b=0; b<nBands; b++) used[b] = iUsed[b] || jUsed[b];
+		ICi = ICj = std::make_shared<RealSpaceWfns>(nBands*nSpinor);
+		computeRealSpaceWfns(C[ik], used, *ICi);
 	}
-	for(int j=0; j<nBands; j++) if(jUsed[j])
-	{	ICj[j].resize(nSpinor);
-		for(int s=0; s<nSpinor; s++)
-			ICj[j][s] = I((slabResponse ? C[jk] : Cj).getColumn(j,s));
+	else
+	{	ICi = getRealSpaceWfns(ik, ki, iUsed, cacheI);
+		ICj = getRealSpaceWfns(jk, kj, jUsed, cacheJ);
 	}
 	watchI.stop();
 	
 	//Initialize pair densities:
 	watchJ.start();
 	const Basis& basis_q = basisChi[iq];
-	int nbasis = basis_q.nbasis;
-	nij = zeroes(nbasis, events.size());
-	complex* nijData = nij.dataPref();
-	for(const Event& event: events)
-	{	complexScalarField Inij;
-		for(int s=0; s<nSpinor; s++)
-			Inij += conjICi[event.i][s] * ICj[event.j][s];
-		callPref(eblas_gather_zdaxpy)(nbasis, 1., basis_q.index.dataPref(), J(Inij)->dataPref(), nijData);
-		nijData += nbasis;
-	}
+	nij = zeroes(basis_q.nbasis, events.size());
+	threadLaunch(isGpuEnabled() ? 1 : 0, pairDensity_thread, events.size(), &events, ICi.get(), ICj.get(), nSpinor, &basis_q, nij.dataPref());
 	watchJ.stop();
 	
 	return events;
 }
 
+void ElectronScattering::pairDensity_thread(int iStart, int iStop, const std::vector<Event>* events, const RealSpaceWfns* ICi, const RealSpaceWfns* ICj, int nSpinor, const Basis* basis_q, complex* nijData)
+{	int nbasis = basis_q->nbasis;
+	for(int iEvent=iStart; iEvent<iStop; iEvent++)
+	{	const Event& event = events->at(iEvent);
+		complexScalarField Inij;
+		for(int s=0; s<nSpinor; s++)
+			Inij += conj(ICi->at(event.i*nSpinor+s)) * ICj->at(event.j*nSpinor+s);
+		callPref(eblas_gather_zdaxpy)(nbasis, 1., basis_q->index.dataPref(), J(Inij)->dataPref(), nijData+iEvent*nbasis);
+	}
+}
+
+inline void realSpaceWfns_thread(int iStart, int iStop, const ColumnBundle* C, const std::vector<int>* bands, std::vector<complexScalarField>* IC)
+{	int nSpinor = C->spinorLength();
+	for(int iBand=iStart; iBand<iStop; iBand++)
+	{	int b = bands->at(iBand);
+		for(int s=0; s<nSpinor; s++)
+			IC->at(b*nSpinor+s) = I(C->getColumn(b,s));
+	}
+}
+
+void ElectronScattering::computeRealSpaceWfns(const ColumnBundle& C, const std::vector<bool>& used, RealSpaceWfns& IC)
+{	std::vector<int> bands; //bands needed but not yet available
+	for(size_t b=0; b<used.size(); b++)
+		if(used[b] && !IC[b*C.spinorLength()])
+			bands.push_back(b);
+	if(bands.size())
+		threadLaunch(isGpuEnabled() ? 1 : 0, realSpaceWfns_thread, bands.size(), &C, &bands, &IC);
+}
+
+std::shared_ptr<ElectronScattering::RealSpaceWfns> ElectronScattering::getRealSpaceWfns(size_t ik, const vector3<>& k, const std::vector<bool>& used, WfnCache& cache) const
+{	double roundErr;
+	vector3<int> kSup = round((k - supercell->kmesh[0]) * supercell->super, &roundErr);
+	assert(roundErr < symmThreshold);
+	//Find in cache or create (and cache if within capacity):
+	std::shared_ptr<RealSpaceWfns> IC;
+	auto iter = cache.entries.find(kSup);
+	if(iter == cache.entries.end())
+	{	IC = std::make_shared<RealSpaceWfns>(nBands*nSpinor);
+		if(cache.entries.size() < cache.capacity)
+			cache.entries[kSup] = IC;
+	}
+	else IC = iter->second;
+	//Compute any missing bands:
+	bool missing = false;
+	for(int b=0; b<nBands; b++)
+		if(used[b] && !IC->at(b*nSpinor))
+		{	missing = true;
+			break;
+		}
+	if(missing)
+	{	cache.nMisses++;
+		computeRealSpaceWfns(getWfns(ik, k), used, *IC);
+	}
+	else cache.nHits++;
+	return IC;
+}
+
 ColumnBundle ElectronScattering::getWfns(size_t ik, const vector3<>& k) const
 {	static StopWatch watch("ElectronScattering::getWfns"); watch.start();
 	double roundErr;
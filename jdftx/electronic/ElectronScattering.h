@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <electronic/Basis.h>
 #include <core/LatticeUtils.h>
+#include <core/ScalarField.h>
 #include <memory>
 
 class ColumnBundle;
@@ -41,6 +42,7 @@ struct ElectronScattering
 	
 	bool slabResponse; //!< whether to work in slab response output mode
 	double EcutTransverse; //!< energy cutoff in directions transverse to slab normal (same as Ecut above if unspecified)
+	double cacheMemory; //!< memory in MB per process for caching real-space wavefunctions between k-point pairs (default: 1024)
 	
 	ElectronScattering();
 	void dump(const Everything& e); //!< compute and dump Im(Sigma_ee) for each eigenstate
@@ -59,6 +61,15 @@ private:
 	std::map< vector3<int>, std::shared_ptr<class ColumnBundleTransform> > transform; //k-mesh transformations
 	std::map< vector3<int>, QuantumNumber > qnumMesh; //equivalent of eInfo.qnums for entire k-mesh
 	
+	typedef std::vector<complexScalarField> RealSpaceWfns; //I(C) for each band and spinor component (band-major; null until needed)
+	struct WfnCache
+	{	std::map< vector3<int>, std::shared_ptr<RealSpaceWfns> > entries; //indexed by k-point offset in supercell, as in transform
+		size_t capacity; //maximum number of k-points retained (entries are never evicted, which is optimal for the cyclic access pattern here)
+		size_t nHits, nMisses; //statistics
+		WfnCache() : capacity(0), nHits(0), nMisses(0) {}
+	};
+	mutable WfnCache cacheI, cacheJ; //real-space wavefunctions of first (retained for entire calculation) and second (retained for each q) states of events
+	
 	struct Event
 	{	int i, j; //band indices
 		double fWeight; //relevant fillings combination ( (fi - fj)/2 or (1-fi-fj) for chiMode = true or false )
@@ -74,6 +85,9 @@ private:
 	) const;
 	
 	ColumnBundle getWfns(size_t ik, const vector3<>& k) const; //get wavefunctions at an arbitrary point in k-mesh
+	std::shared_ptr<RealSpaceWfns> getRealSpaceWfns(size_t ik, const vector3<>& k, const std::vector<bool>& used, WfnCache& cache) const; //get real-space wavefunctions (at least of bands marked used) at an arbitrary point in k-mesh
+	static void computeRealSpaceWfns(const ColumnBundle& C, const std::vector<bool>& used, RealSpaceWfns& IC); //fill in real-space wavefunctions of used bands that are not yet available
+	static void pairDensity_thread(int iStart, int iStop, const std::vector<Event>* events, const RealSpaceWfns* ICi, const RealSpaceWfns* ICj, int nSpinor, const Basis* basis_q, complex* nijData);
 	matrix coulombMatrix(size_t iq) const; //retrieve the Coulomb operator for a specific momentum transfer
 	void dumpSlabResponse(Everything& e, const diagMatrix& omegaGrid);
 };
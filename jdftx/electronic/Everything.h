@@ -33,6 +33,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Energies.h>
 #include <electronic/ExCorr.h>
 #include <electronic/Dump.h>
+#include <electronic/Checkpoint.h>
 #include <electronic/SCFparams.h>
 #include <electronic/IonDynamicsParams.h>
 #include <memory>
@@ -46,6 +47,7 @@ class Everything
 public:
 	Control cntrl;  //!< control variables
 	Dump dump;      //!< output options
+	Checkpoint checkpoint; //!< periodic asynchronous checkpoints for restart
 	GridInfo gInfo; //!< main grid descriptor
 	std::shared_ptr<GridInfo> gInfoWfns; //!< tighter grid sufficient for wavefunction operations
 	std::vector<Basis> basis; //!< wavefunction basis for all k points
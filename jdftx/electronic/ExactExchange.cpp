@@ -56,7 +56,7 @@ private:
 };
 
 
-ExactExchange::ExactExchange(const Everything& e) : e(e)
+ExactExchange::ExactExchange(const Everything& e) : freezeACE(false), e(e), EXXace(0.)
 {
 	logPrintf("\n---------- Setting up exact exchange ----------\n");
 	eval = new ExactExchangeEval(e);
@@ -91,6 +91,51 @@ double ExactExchange::operator()(double aXX, double omega,
 	return EXX;
 }
 
+double ExactExchange::prepareACE(double aXX, double omega, const std::vector<diagMatrix>& F, const std::vector<ColumnBundle>& C)
+{	//Apply the full exchange operator once on all the current wavefunctions:
+	std::vector<ColumnBundle> W(e.eInfo.nStates); //W = Vx C
+	EXXace = (*this)(aXX, omega, F, C, &W);
+	
+	static StopWatch watch("ExactExchange::prepareACE"); watch.start();
+	//Compress: Vx_ACE = W (C^W)^-1 W^ = -xi xi^ with xi = W (-C^W)^(-1/2), which satisfies Vx_ACE C = W exactly
+	xi.assign(e.eInfo.nStates, ColumnBundle());
+	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+	{	matrix M = C[q] ^ W[q]; //negative semi-definite since exchange is attractive
+		//Inverse square root restricted to the range of -M (which is singular e.g. for states with no occupied partners):
+		matrix U; diagMatrix eigs;
+		dagger_symmetrize(-M).diagonalize(U, eigs);
+		double eigMax = 0.;
+		for(double eig: eigs) eigMax = std::max(eigMax, eig);
+		const double eigThreshold = 1e-12 * eigMax;
+		diagMatrix eigsInvSqrt(eigs.nRows(), 0.);
+		for(int i=0; i<eigs.nRows(); i++)
+			if(eigs[i] > eigThreshold && eigs[i] > 0.)
+				eigsInvSqrt[i] = 1./sqrt(eigs[i]);
+		xi[q] = W[q] * (U * eigsInvSqrt * dagger(U));
+		W[q].free();
+	}
+	watch.stop();
+	return EXXace;
+}
+
+double ExactExchange::applyACE(int q, const diagMatrix& Fq, const ColumnBundle& Cq, ColumnBundle* HCq) const
+{	static StopWatch watch("ExactExchange::applyACE"); watch.start();
+	assert(xi[q]);
+	matrix xiDagC = xi[q] ^ Cq;
+	if(HCq) *HCq -= xi[q] * xiDagC;
+	double Eq = -e.eInfo.qnums[q].weight * trace(Fq * (dagger(xiDagC) * xiDagC)).real();
+	watch.stop();
+	return Eq;
+}
+
+bool ExactExchange::hasACE() const
+{	return xi.size();
+}
+
+void ExactExchange::clearACE()
+{	xi.clear();
+}
+
 //--------------- class ExactExchangeEval implementation ----------------------
 
 
@@ -40,9 +40,25 @@ public:
 	double operator()(double aXX, double omega,
 		const std::vector<diagMatrix>& F, const std::vector<ColumnBundle>& C,
 		std::vector<ColumnBundle>* HC = 0) const;
+	
+	//! Build the adaptively compressed exchange (ACE) operator Vx = -xi xi^ for scale aXX and range omega,
+	//! which reproduces the exact exchange operator on the current wavefunctions C (returns exact energy at C)
+	double prepareACE(double aXX, double omega, const std::vector<diagMatrix>& F, const std::vector<ColumnBundle>& C);
+	
+	//! Apply the ACE operator on Cq, accumulating to HCq if non-null (gradient upto weights and fillings),
+	//! and return the corresponding weighted expectation value w_q Tr(Fq Cq^ Vx Cq) for state q
+	double applyACE(int q, const diagMatrix& Fq, const ColumnBundle& Cq, ColumnBundle* HCq) const;
+	
+	bool hasACE() const; //!< whether an ACE operator is available
+	void clearACE(); //!< discard ACE operator (eg. when the basis changes)
+	double getEXXace() const { return EXXace; } //!< exact exchange energy at the wavefunctions used to build the ACE operator
+	
+	bool freezeACE; //!< if set, energy evaluations reuse the current ACE operator instead of rebuilding it (outer-loop minimization)
 private:
 	const Everything& e;
 	class ExactExchangeEval* eval; //!< opaque pointer to an internal computation class
+	std::vector<ColumnBundle> xi; //!< ACE projectors for each state (empty if unavailable)
+	double EXXace; //!< exact exchange energy at construction of the ACE operator
 };
 
 //! @}
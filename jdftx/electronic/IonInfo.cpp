@@ -257,6 +257,10 @@ void IonInfo::augmentOverlap(const ColumnBundle& Cq, ColumnBundle& OCq, std::vec
 		species[sp]->augmentOverlap(Cq, OCq, VdagCq ? &VdagCq->at(sp) : 0);
 }
 
+bool IonInfo::hasAugmentation() const
+{	for(auto sp: species) if(sp->hasAugmentation()) return true;
+	return false;
+}
 void IonInfo::augmentDensityInit() const
 {	for(auto sp: species) ((SpeciesInfo&)(*sp)).augmentDensityInit();
 }
@@ -276,20 +280,60 @@ void IonInfo::augmentDensitySphericalGrad(const QuantumNumber& qnum, const diagM
 		species[sp]->augmentDensitySphericalGrad(qnum, Fq, VdagCq[sp], HVdagCq[sp]);
 }
 
+//Transform bands to real space once and gather the projector spheres of all species from each:
+inline void gatherRealSpace_sub(size_t bStart, size_t bStop, const ColumnBundle* Cq, std::vector<SpeciesInfo::RealSpaceSpheres>* psi)
+{	for(size_t b=bStart; b<bStop; b++)
+	{	complexScalarField psiR = I(Cq->getColumn(b,0));
+		for(SpeciesInfo::RealSpaceSpheres& psiSp: *psi)
+			if(psiSp.Vreal) psiSp.gather(b, psiR->data());
+	}
+}
+
+//Scatter the projector spheres of all species to one grid per band, and transform back once:
+inline void scatterRealSpace_sub(size_t bStart, size_t bStop, const std::vector<SpeciesInfo::RealSpaceSpheres>* phi, ColumnBundle* HCq)
+{	for(size_t b=bStart; b<bStop; b++)
+	{	complexScalarField phiR; nullToZero(phiR, *(HCq->basis->gInfo));
+		for(const SpeciesInfo::RealSpaceSpheres& phiSp: *phi)
+			if(phiSp.Vreal) phiSp.scatter(b, phiR->data());
+		HCq->accumColumn(b,0, Idag(phiR));
+	}
+}
+
 void IonInfo::project(const ColumnBundle& Cq, std::vector<matrix>& VdagCq, matrix* rotExisting) const
 {	VdagCq.resize(species.size());
+	std::vector<SpeciesInfo::RealSpaceSpheres> psi(species.size()); //wavefunctions within spheres for species using real-space projectors
+	bool anyRealSpace = false;
 	for(unsigned sp=0; sp<e->iInfo.species.size(); sp++)
-	{	if(rotExisting && VdagCq[sp]) VdagCq[sp] = VdagCq[sp] * (*rotExisting); //rotate and keep the existing projections
+	{	if(rotExisting && VdagCq[sp]) VdagCq[sp] = VdagCq[sp] * (*rotExisting);
+		else if(species[sp]->useRealSpaceProjectors(Cq))
+		{	psi[sp] = species[sp]->initRealSpaceSpheres(Cq);
+			anyRealSpace = true;
+		}
 		else
 		{	auto V = e->iInfo.species[sp]->getV(Cq);
 			if(V) VdagCq[sp] = (*V) ^ Cq;
 		}
 	}
+	if(anyRealSpace)
+	{	threadLaunch(isGpuEnabled() ? 1 : 0, gatherRealSpace_sub, Cq.nCols(), &Cq, &psi);
+		for(unsigned sp=0; sp<species.size(); sp++)
+			if(psi[sp].Vreal) VdagCq[sp] = species[sp]->projectRealSpace(Cq, psi[sp]);
+	}
 }
-
 void IonInfo::projectGrad(const std::vector<matrix>& HVdagCq, const ColumnBundle& Cq, ColumnBundle& HCq) const
-{	for(unsigned sp=0; sp<species.size(); sp++)
-		if(HVdagCq[sp]) HCq += *(species[sp]->getV(Cq)) * HVdagCq[sp];
+{	std::vector<SpeciesInfo::RealSpaceSpheres> phi(species.size()); //gradients within spheres for species using real-space projectors
+	bool anyRealSpace = false;
+	for(unsigned sp=0; sp<species.size(); sp++)
+		if(HVdagCq[sp])
+		{	if(species[sp]->useRealSpaceProjectors(Cq))
+			{	phi[sp] = species[sp]->projectGradRealSpace(HVdagCq[sp], Cq);
+				anyRealSpace = true;
+			}
+			else
+				HCq += *(species[sp]->getV(Cq)) * HVdagCq[sp];
+		}
+	if(anyRealSpace)
+		threadLaunch(isGpuEnabled() ? 1 : 0, scatterRealSpace_sub, Cq.nCols(), &phi, &HCq);
 }
 
 //----- DFT+U functions --------
@@ -88,6 +88,7 @@ public:
 	void augmentOverlap(const ColumnBundle& Cq, ColumnBundle& OCq, std::vector<matrix>* VdagCq=0) const;
 	
 	//Multi-stage density augmentation and gradient propagation (see corresponding functions in SpeciesInfo)
+	bool hasAugmentation() const; //!< whether any species contributes density augmentation (ultrasoft)
 	void augmentDensityInit() const; //!< initialize density augmentation
 	void augmentDensitySpherical(const QuantumNumber& qnum, const diagMatrix& Fq, const std::vector<matrix>& VdagCq) const; //!< calculate density augmentation in spherical functions
 	void augmentDensityGrid(ScalarFieldArray& n) const; //!< propagate from spherical functions to grid
@@ -20,6 +20,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/LatticeMinimizer.h>
 #include <electronic/Everything.h>
 #include <electronic/ColumnBundle.h>
+#include <electronic/ExactExchange.h>
 #include <core/LatticeUtils.h>
 #include <core/Random.h>
 
@@ -283,6 +284,7 @@ void LatticeMinimizer::updateLatticeDependent(Everything& e, bool ignoreElectron
 	e.updateSupercell();
 	e.coulomb = e.coulombParams.createCoulomb(e.gInfo);
 	e.iInfo.update(e.ener);
+	if(e.exx) e.exx->clearACE(); //compressed exchange operator is invalidated by the change of metric
 	if(!ignoreElectronic)
 	{	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
 			e.eVars.orthonormalize(q);
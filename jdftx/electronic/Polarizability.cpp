@@ -25,7 +25,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/VectorField.h>
 #include <core/ScalarFieldIO.h>
 
-Polarizability::Polarizability() : eigenBasis(NonInteracting), Ecut(0), nEigs(0)
+Polarizability::Polarizability() : eigenBasis(NonInteracting), Ecut(0), nEigs(0), blockMemory(1024.)
 {
 }
 
@@ -99,7 +99,7 @@ class PairDensityCalculator
 
 public:
 	//Setup to compute pair densities between kmesh[ik] and its partner dk away
-	PairDensityCalculator(const Everything& e, const vector3<>& dk, int ik)
+	PairDensityCalculator(const Everything& e, const vector3<>& dk, int ik) : IC2start(0)
 	{
 		//Find the transformations / data sources for the two k-points:
 		const std::vector< vector3<> >& kmesh = e.coulombParams.supercell->kmesh;
@@ -131,41 +131,76 @@ public:
 		}
 	}
 
-	//Store resulting pair densities scaled by 2*invsqrt(eigenvalue differences) in rho,
+	//Store resulting pair densities of occupied bands [vStart,vStop) with unoccupied bands [cStart,cStop),
+	//scaled by 2*invsqrt(eigenvalue differences) in rho starting at column kOffset,
 	//so that the non-interacting susceptibility is negative identity in this basis.
-	void compute(int nV, int nC, ColumnBundle& rho, int kOffset) const
-	{	threadLaunch(isGpuEnabled() ? 1 : 0, compute_thread, nV*nC, nV, nC, &rho, kOffset, this);
+	void compute(int vStart, int vStop, int cStart, int cStop, int nV, ColumnBundle& rho, int kOffset)
+	{	int nCblock = cStop - cStart;
+		if(IC2start != cStart || int(IC2.size()) != nCblock) //real-space unoccupied wavefunctions, reused for all occupied bands
+		{	IC2.assign(nCblock, complexScalarField());
+			IC2start = cStart;
+			threadLaunch(isGpuEnabled() ? 1 : 0, conduction_thread, nCblock, nV, this);
+		}
+		threadLaunch(isGpuEnabled() ? 1 : 0, compute_thread, (vStop-vStart)*nCblock, vStart, nV, &rho, kOffset, this);
 	}
 	
-	//Accumulate contribution from currentkpoint pair to negative of noninteracting susceptibility in plane-wave basis:
-	void accumMinusXniPW(int nV, int nC, const Basis& basis, matrix& minusXni)
-	{	assert(minusXni.nRows() == int(basis.nbasis));
+	//Accumulate contribution from current kpoint pair to negative of noninteracting susceptibility in plane-wave basis,
+	//processing blocks of band pairs such that the pair densities and the cached real-space
+	//unoccupied wavefunctions together fit within blockMemory (in MB):
+	void accumMinusXniPW(int nV, int nC, const Basis& basis, matrix& minusXni, double blockMemory)
+	{	static StopWatch watch("Polarizability::accumMinusXniPW");
+		assert(minusXni.nRows() == int(basis.nbasis));
 		assert(minusXni.nCols() == int(basis.nbasis));
-		ColumnBundle rho(nV*nC, basis.nbasis, &basis);
-		compute(nV, nC, rho, 0);
-		//Xni += (detR)*rho*dagger(rho):
-		callPref(eblas_zgemm)(CblasNoTrans, CblasConjTrans, basis.nbasis, basis.nbasis, rho.nCols(),
-			basis.gInfo->detR, rho.dataPref(), rho.colLength(), rho.dataPref(), rho.colLength(),
-			1., minusXni.dataPref(), minusXni.nRows());
+		double budget = blockMemory*1024*1024;
+		//Unoccupied bands cached in real space (at most half the budget):
+		double orbitalBytes = basis.gInfo->nr * sizeof(complex); //memory per unoccupied band
+		int nCblock = std::max(1, std::min(nC, int(0.5*budget / orbitalBytes)));
+		//Occupied bands whose pair densities with the cached unoccupied bands fit in the rest:
+		double pairBytes = nCblock * basis.nbasis * sizeof(complex); //memory per occupied band
+		int nVblock = std::max(1, std::min(nV, int((budget - nCblock*orbitalBytes) / pairBytes)));
+		ColumnBundle rho(nVblock*nCblock, basis.nbasis, &basis);
+		for(int cStart=0; cStart<nC; cStart+=nCblock)
+		{	int cStop = std::min(cStart+nCblock, nC);
+			for(int vStart=0; vStart<nV; vStart+=nVblock)
+			{	int vStop = std::min(vStart+nVblock, nV);
+				int nPairs = (vStop-vStart)*(cStop-cStart);
+				compute(vStart, vStop, cStart, cStop, nV, rho, 0);
+				//Xni += (detR)*rho*dagger(rho):
+				watch.start();
+				callPref(eblas_zgemm)(CblasNoTrans, CblasConjTrans, basis.nbasis, basis.nbasis, nPairs,
+					basis.gInfo->detR, rho.dataPref(), rho.colLength(), rho.dataPref(), rho.colLength(),
+					1., minusXni.dataPref(), minusXni.nRows());
+				watch.stop();
+			}
+		}
+		IC2.clear();
 	}
 	
 private:
-	void compute_sub(int bStart, int bStop, int nV, int nC, ColumnBundle* rho, int kOffset) const
-	{	int b = bStart;
-		int v = b / nC;
-		int c = b - v*nC;
+	std::vector<complexScalarField> IC2; //real-space wavefunctions of unoccupied bands [IC2start,IC2start+IC2.size()) of state2
+	int IC2start;
+	
+	void compute_sub(int bStart, int bStop, int vStart, int nV, ColumnBundle* rho, int kOffset) const
+	{	int nCblock = IC2.size();
+		int b = bStart;
+		int v = vStart + b / nCblock;
+		int c = b % nCblock;
 		complexScalarField conjICv = conj(I(state1.getColumn(v)));
 		while(b<bStop)
-		{	double sqrtEigDen = sqrt(4./(nK * (state2.eig->at(nV+c) - state1.eig->at(v))));
-			rho->setColumn(kOffset+b,0, sqrtEigDen * J(conjICv * I(state2.getColumn(nV+c))));
+		{	double sqrtEigDen = sqrt(4./(nK * (state2.eig->at(nV+IC2start+c) - state1.eig->at(v))));
+			rho->setColumn(kOffset+b,0, sqrtEigDen * J(conjICv * IC2[c]));
 			//Next cv pair:
 			b++; if(b==bStop) break;
 			c++;
-			if(c==nC) { c=0; v++; conjICv = conj(I(state1.getColumn(v))); }
+			if(c==nCblock) { c=0; v++; conjICv = conj(I(state1.getColumn(v))); }
 		}
 	}
-	static void compute_thread(int bStart, int bStop, int nV, int nC, ColumnBundle* rho, int kOffset, const PairDensityCalculator* pdc)
-	{	pdc->compute_sub(bStart, bStop, nV, nC, rho, kOffset);
+	static void compute_thread(int bStart, int bStop, int vStart, int nV, ColumnBundle* rho, int kOffset, const PairDensityCalculator* pdc)
+	{	pdc->compute_sub(bStart, bStop, vStart, nV, rho, kOffset);
+	}
+	static void conduction_thread(int cStart, int cStop, int nV, PairDensityCalculator* pdc)
+	{	for(int c=cStart; c<cStop; c++)
+			pdc->IC2[c] = I(pdc->state2.getColumn(nV+pdc->IC2start+c));
 	}
 };
 
@@ -308,13 +343,13 @@ void Polarizability::dump(const Everything& e)
 		//Get the PW basis non-interacting susceptibility matrix:
 		matrix minusXni(nColumns, nColumns); minusXni.zero();
 		for(int ik=0; ik<nK; ik++)
-			PairDensityCalculator(e, dk, ik).accumMinusXniPW(nV, nC, basis, minusXni);
+			PairDensityCalculator(e, dk, ik).accumMinusXniPW(nV, nC, basis, minusXni, blockMemory);
 		Xni = -minusXni;
 	}
 	else
 	{	logPrintf("\tComputing occupied x unoccupied (CV) pair-densities and NonInteracting polarizability\n"); logFlush();
 		for(int ik=0; ik<nK; ik++)
-			PairDensityCalculator(e, dk, ik).compute(nV, nC, V, ik*nV*nC);
+			PairDensityCalculator(e, dk, ik).compute(0, nV, 0, nC, nV, V, ik*nV*nC);
 		matrix invXni = -eye(nColumns); //inverse of non-interacting susceptibility
 		logPrintf("\tOrthonormalizing basis\n"); logFlush();
 		matrix Umhalf = invsqrt(e.gInfo.detR*(V^V));
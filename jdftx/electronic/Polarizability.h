@@ -39,6 +39,7 @@ struct Polarizability
 	
 	double Ecut; //!< energy-cutoff for occupied-valence pair densities (if zero, 4*Ecut of wavefunctions)
 	int nEigs; //!< number of eigenvectors in output (if zero, output all)
+	double blockMemory; //!< memory in MB for each block of pair densities and cached unoccupied wavefunctions in the plane-wave basis (default: 1024)
 	
 	vector3<> dk; //!< k-point difference at which to obtain results
 	
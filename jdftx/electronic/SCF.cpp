@@ -151,6 +151,8 @@ void SCF::report(int iter)
 		saveState(fname.c_str());
 		logPrintf("done\n"); logFlush();
 	}
+	//--- periodic checkpoint (including SCF history):
+	e.checkpoint.save(e, iter, [this](FILE* fp) { saveState(fp); });
 }
 
 
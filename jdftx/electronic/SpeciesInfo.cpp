@@ -37,6 +37,7 @@ void SpeciesInfo::sync_atpos()
 	atposManaged = ManagedArray<vector3<>>(atpos); //it will get transferred to GPU if/when necessary
 	//Invalidate cached projectors:
 	cachedV.clear();
+	cachedVreal.clear();
 }
 
 inline bool isParallel(vector3<> x, vector3<> y)
@@ -98,6 +99,7 @@ SpeciesInfo::SpeciesInfo()
 	Z_chargeball = 0.0; width_chargeball = 0.0;
 	tauCore_rCut = 0.; tauCorePlot = false;
 	dE_dnG = 0.0;
+	VrealReported = false;
 	mass = 0.0;
 	coreRadius = 0.;
 	initialOxidationState = 0.;
@@ -424,6 +426,7 @@ void SpeciesInfo::updateLatticeDependent()
 		tauCoreRadial.updateGmax(0, nGridLoc);
 		for(auto& Qijl: Qradial) Qijl.second.updateGmax(Qijl.first.l, nGridLoc);
 		cachedV.clear(); //clear any cached projectors
+		cachedVreal.clear();
 	}
 	
 	//Update Qradial indices, matrix and nagIndex if not previously init'd, or if R has changed:
@@ -502,6 +505,7 @@ void SpeciesInfo::setupPulay()
 
 matrix SpeciesInfo::getYlmToSpinAngleMatrix(int l, int j2)
 {	static std::map< std::pair<int,int>, matrix > cache;
+	static std::mutex cacheLock; std::lock_guard<std::mutex> lock(cacheLock); //may be called from concurrent band minimizations
 	assert(j2==2*l-1 || j2==2*l+1);
 	std::pair<int,int> key(l,j2);
 	auto iter = cache.find(key);
@@ -549,6 +553,7 @@ matrix SpeciesInfo::getYlmToSpinAngleMatrix(int l, int j2)
 
 matrix SpeciesInfo::getYlmOverlapMatrix(int l, int j2)
 {	static std::map< std::pair<int,int>, matrix > cache;
+	static std::mutex cacheLock; std::lock_guard<std::mutex> lock(cacheLock); //may be called from concurrent band minimizations
 	assert(j2==2*l-1 || j2==2*l+1);
 	std::pair<int,int> key(l,j2);
 	auto iter = cache.find(key);
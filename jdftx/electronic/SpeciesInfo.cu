@@ -46,6 +46,38 @@ void Vnl_gpu(int nbasis, int atomStride, int nAtoms, int l, int m, vector3<> k,
 	SwitchTemplate_lm(l,m, Vnl_gpu, (nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, V) )
 }
 
+//Structure factors from separable phase tables
+__global__
+void structureFactor_kernel(int nbasis, int nAtoms, const vector3<int>* iGarr, const vector3<int> S, const complex* phaseTables, complex* sf)
+{	int n = kernelIndex1D();
+	if(n<nbasis) structureFactor_calc(n, nbasis, nAtoms, iGarr, S, phaseTables, sf);
+}
+void structureFactor_gpu(int nbasis, int nAtoms, const vector3<int>* iGarr, const vector3<int> S, const complex* phaseTables, complex* sf)
+{	GpuLaunchConfig1D glc(structureFactor_kernel, nbasis);
+	structureFactor_kernel<<<glc.nBlocks,glc.nPerBlock>>>(nbasis, nAtoms, iGarr, S, phaseTables, sf);
+	gpuErrorCheck();
+}
+
+//Calculate non-local pseudopotential projector given structure factors
+template<int l, int m> __global__
+void VnlSF_kernel(int nbasis, int atomStride, int nAtoms, vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* sf, const RadialFunctionG VnlRadial, complex* V)
+{	int n = kernelIndex1D();
+	if(n<nbasis) VnlSF_calc<l,m>(n, nbasis, atomStride, nAtoms, k, iGarr, G, sf, VnlRadial, V);
+}
+template<int l, int m>
+void Vnl_gpu(int nbasis, int atomStride, int nAtoms, vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* sf, const RadialFunctionG& VnlRadial, complex* V)
+{	GpuLaunchConfig1D glc(VnlSF_kernel<l,m>, nbasis);
+	VnlSF_kernel<l,m><<<glc.nBlocks,glc.nPerBlock>>>(nbasis, atomStride, nAtoms, k, iGarr, G, sf, VnlRadial, V);
+	gpuErrorCheck();
+}
+void Vnl_gpu(int nbasis, int atomStride, int nAtoms, int l, int m, vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* sf, const RadialFunctionG& VnlRadial, complex* V)
+{
+	SwitchTemplate_lm(l,m, Vnl_gpu, (nbasis, atomStride, nAtoms, k, iGarr, G, sf, VnlRadial, V) )
+}
+
 
 //Augment electron density by spherical functions
 template<int Nlm> __global__ void nAugment_kernel(int zBlock, const vector3<int> S, const matrix3<> G, int iGstart, int iGstop,
@@ -27,6 +27,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/ScalarFieldArray.h>
 #include <core/vector3.h>
 #include <core/string.h>
+#include <mutex>
 
 class ColumnBundle;
 class QuantumNumber;
@@ -94,9 +95,32 @@ public:
 	//! projected electronic gradient in HVdagCq (if non-null)
 	double EnlAndGrad(const QuantumNumber& qnum, const diagMatrix& Fq, const matrix& VdagCq, matrix& HVdagCq) const;
 	
+	//Real-space projector application (implemented in SpeciesInfo_realSpace.cpp, see Control::realSpaceProjectors).
+	//IonInfo::project and IonInfo::projectGrad transform each band once, and all species gather from / scatter to that grid:
+	
+	//! Nonlocal projectors in real space, truncated to a sphere of grid points around each atom (for one k-point and basis)
+	struct RealSpaceProjectors
+	{	std::vector<std::vector<int> > index; //!< grid point indices within the sphere around each atom
+		std::vector<matrix> V; //!< projector values (grid points x projectors) for each atom
+	};
+	
+	//! Band values restricted to the projector spheres around each atom
+	struct RealSpaceSpheres
+	{	std::shared_ptr<RealSpaceProjectors> Vreal; //!< projectors defining the spheres (null if unused)
+		std::vector<matrix> values; //!< values (sphere grid points x bands) for each atom
+		void gather(int b, const complex* psiR); //!< collect band b from full-grid data psiR
+		void scatter(int b, complex* phiR) const; //!< accumulate band b to full-grid data phiR
+	};
+	
+	bool useRealSpaceProjectors(const ColumnBundle& Cq) const; //!< whether projections for Cq should be computed in real space
+	RealSpaceSpheres initRealSpaceSpheres(const ColumnBundle& Cq) const; //!< allocate sphere storage for all bands of Cq (to be filled using RealSpaceSpheres::gather)
+	matrix projectRealSpace(const ColumnBundle& Cq, const RealSpaceSpheres& psi) const; //!< compute V^Cq from Cq gathered to the spheres (psi)
+	RealSpaceSpheres projectGradRealSpace(const matrix& HVdagCq, const ColumnBundle& Cq) const; //!< compute V*HVdagCq within the spheres (to be accumulated using RealSpaceSpheres::scatter)
+	
 	//! Accumulate pseudopotential contribution to the overlap in OCq
 	void augmentOverlap(const ColumnBundle& Cq, ColumnBundle& OCq, matrix* VdagCq=0) const;
 	
+	bool hasAugmentation() const { return atpos.size() && Qint.size(); } //!< whether this species contributes density augmentation (ultrasoft)
 	//! Clear internal data and prepare for density augmentation (call before a loop ober augmentDensitySpherical per k-point)
 	void augmentDensityInit();
 	//! Accumulate the pseudopotential dependent contribution to the density in the spherical functions nAug (call once per k-point)
@@ -160,6 +184,12 @@ private:
 	matrix QintAll; //!< block matrix containing Qint for all l,m 
 	
 	std::map<std::pair<vector3<>,const Basis*>, std::shared_ptr<ColumnBundle> > cachedV; //cached projectors (identified by k-point and basis pointer)
+	void getStructureFactor(const Basis& basis, const vector3<>& k, ManagedArray<complex>& sf) const; //!< structure factors (nbasis x nAtoms) shared by all projector / orbital channels at k
+	
+	std::map<std::pair<vector3<>,const Basis*>, std::shared_ptr<RealSpaceProjectors> > cachedVreal; //cached real-space projectors (identified as for cachedV)
+	std::shared_ptr<RealSpaceProjectors> getVreal(const ColumnBundle& Cq) const; //!< retrieve real-space projectors from cache, computing if necessary
+	mutable bool VrealReported; //!< whether the real-space projector truncation has been logged (reported once per run)
+	mutable std::mutex cacheLock; //!< guards cachedV and cachedVreal when quantum numbers are solved concurrently
 	
 	struct QijIndex
 	{	int l1, p1; //!< Angular momentum and projector index for channel i
@@ -178,6 +178,7 @@ void SpeciesInfo::setAtomicOrbitals(ColumnBundle& psi, bool applyO, unsigned n,
 	assert(colOffset + atomColStride*int(atpos.size()-1) + nOrbitalsPerAtom <= psi.nCols());
 	if(nSpinCopies>1) assert(psi.isSpinor()); //can have multiple spinor copies only in spinor mode
 	const Basis& basis = *psi.basis;
+	ManagedArray<complex> sf; getStructureFactor(basis, psi.qnum->k, sf);
 	if(isRelativistic() && l>0)
 	{	//find the two orbital indices corresponding to different j of same n
 		std::vector<int> pArr; 
@@ -195,7 +196,7 @@ void SpeciesInfo::setAtomicOrbitals(ColumnBundle& psi, bool applyO, unsigned n,
 		for(int p: pArr) for(int m=-l; m<=l; m++)
 		{	size_t atomStride = V.colLength() * nOrbitalsPerAtom;
 			size_t offs = iCol * V.colLength();
-			callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, psi.qnum->k, basis.iGarr.dataPref(), e->gInfo.G, atposManaged.dataPref(), fRadial[l][p], V.dataPref()+offs);
+			callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, psi.qnum->k, basis.iGarr.dataPref(), e->gInfo.G, sf.dataPref(), fRadial[l][p], V.dataPref()+offs);
 			iCol++;
 		}
 		//Transform the non-spinor ColumnBundle to the spinorial j eigenfunctions:
@@ -212,7 +213,7 @@ void SpeciesInfo::setAtomicOrbitals(ColumnBundle& psi, bool applyO, unsigned n,
 		{	//Set atomic orbitals for all atoms at specified (n,l,m):
 			size_t atomStride = psi.colLength() * atomColStride;
 			size_t offs = iCol * psi.colLength();
-			callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, psi.qnum->k, basis.iGarr.dataPref(), e->gInfo.G, atposManaged.dataPref(), fRadial[l][n], psi.dataPref()+offs);
+			callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, psi.qnum->k, basis.iGarr.dataPref(), e->gInfo.G, sf.dataPref(), fRadial[l][n], psi.dataPref()+offs);
 			if(nSpinCopies>1) //make copy for other spin
 			{	complex* dataPtr = psi.dataPref()+offs;
 				for(size_t a=0; a<atpos.size(); a++)
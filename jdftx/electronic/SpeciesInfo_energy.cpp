@@ -253,6 +253,20 @@ void SpeciesInfo::accumNonlocalForces(const ColumnBundle& Cq, const matrix& Vdag
 	}
 }
 
+void SpeciesInfo::getStructureFactor(const Basis& basis, const vector3<>& k, ManagedArray<complex>& sf) const
+{	//Per-atom phase tables along each reciprocal lattice direction (layout as in structureFactor_calc):
+	const vector3<int>& S = basis.gInfo->S;
+	std::vector<complex> phaseTables; phaseTables.reserve(atpos.size() * (S[0]+S[1]+S[2]+3));
+	for(const vector3<>& pos: atpos)
+		for(int dir=0; dir<3; dir++)
+			for(int iG=-S[dir]/2; iG<=S[dir]-S[dir]/2; iG++)
+				phaseTables.push_back(cis((-2*M_PI)*pos[dir]*(k[dir]+iG)));
+	ManagedArray<complex> phaseTablesManaged(phaseTables);
+	//Combine into structure factors:
+	sf.init(basis.nbasis * atpos.size(), isGpuEnabled());
+	callPref(structureFactor)(basis.nbasis, atpos.size(), basis.iGarr.dataPref(), S, phaseTablesManaged.dataPref(), sf.dataPref());
+}
+
 std::shared_ptr<ColumnBundle> SpeciesInfo::getV(const ColumnBundle& Cq, matrix* M) const
 {	const QuantumNumber& qnum = *(Cq.qnum);
 	const Basis& basis = *(Cq.basis);
@@ -269,23 +283,28 @@ std::shared_ptr<ColumnBundle> SpeciesInfo::getV(const ColumnBundle& Cq, matrix*
 	if(!nProj) return 0; //purely local psp
 	//First check cache
 	if(e->cntrl.cacheProjectors)
-	{	auto iter = cachedV.find(cacheKey);
+	{	std::lock_guard<std::mutex> lock(cacheLock);
+		auto iter = cachedV.find(cacheKey);
 		if(iter != cachedV.end()) //found
 			return iter->second; //return cached value
 	}
 	//No cache / not found in cache; compute:
 	std::shared_ptr<ColumnBundle> V = std::make_shared<ColumnBundle>(nProj*atpos.size(), basis.nbasis, &basis, &qnum, isGpuEnabled()); //not a spinor regardless of spin type
+	ManagedArray<complex> sf; getStructureFactor(basis, qnum.k, sf);
 	int iProj = 0;
 	for(int l=0; l<int(VnlRadial.size()); l++)
 		for(unsigned p=0; p<VnlRadial[l].size(); p++)
 			for(int m=-l; m<=l; m++)
 			{	size_t offs = iProj * basis.nbasis;
 				size_t atomStride = nProj * basis.nbasis;
-				callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, qnum.k, basis.iGarr.dataPref(), basis.gInfo->G, atposManaged.dataPref(), VnlRadial[l][p], V->dataPref()+offs);
+				callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, qnum.k, basis.iGarr.dataPref(), basis.gInfo->G, sf.dataPref(), VnlRadial[l][p], V->dataPref()+offs);
 				iProj++;
 			}
-	//Add to cache if necessary:
-	if(e->cntrl.cacheProjectors)
+	//Add to cache if necessary. In real-space mode, the Hamiltonian does not use these, but ultrasoft overlaps
+	//and DFT+U occupations still need them at every electronic step, so such species keep them cached:
+	if(e->cntrl.cacheProjectors && (!e->cntrl.realSpaceProjectors || Qint.size() || plusU.size()))
+	{	std::lock_guard<std::mutex> lock(cacheLock);
 		((SpeciesInfo*)this)->cachedV[cacheKey] = V;
+	}
 	return V;
 }
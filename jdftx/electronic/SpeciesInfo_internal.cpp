@@ -36,6 +36,22 @@ void Vnl(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k
 {	SwitchTemplate_lm(l,m, Vnl, (nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, V) )
 }
 
+//Structure factors from separable phase tables
+void structureFactor(int nbasis, int nAtoms, const vector3<int>* iGarr, const vector3<int> S, const complex* phaseTables, complex* sf)
+{	threadedLoop(structureFactor_calc, nbasis, nbasis, nAtoms, iGarr, S, phaseTables, sf);
+}
+
+//Initialize non-local projector from a radial function at a particular l,m given structure factors
+template<int l, int m>
+void Vnl(int nbasis, int atomStride, int nAtoms, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* sf, const RadialFunctionG& VnlRadial, complex* V)
+{	threadedLoop(VnlSF_calc<l,m>, nbasis, nbasis, atomStride, nAtoms, k, iGarr, G, sf, VnlRadial, V);
+}
+void Vnl(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* sf, const RadialFunctionG& VnlRadial, complex* V)
+{	SwitchTemplate_lm(l,m, Vnl, (nbasis, atomStride, nAtoms, k, iGarr, G, sf, VnlRadial, V) )
+}
+
 //Augment electron density by spherical functions
 template<int Nlm> void nAugment_sub(size_t diStart, size_t diStop, const vector3<int> S, const matrix3<>& G, int iGstart,
 	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos, complex* n)
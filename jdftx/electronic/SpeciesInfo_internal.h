@@ -51,6 +51,46 @@ void Vnl_gpu(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3
 	const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, complex* Vnl);
 #endif
 
+//! Compute structure factors cis(-2 pi pos.(k+G)) of multiple atoms for a subset of the basis space,
+//! as products of per-atom phase tables along each reciprocal lattice direction.
+//! The table for direction dir contains S[dir]+1 entries for iG[dir] = -S[dir]/2 to S[dir]/2,
+//! and the three tables for each atom are stored consecutively.
+__hostanddev__ void structureFactor_calc(int n, int nbasis, int nAtoms, const vector3<int>* iGarr,
+	const vector3<int>& S, const complex* phaseTables, complex* sf)
+{	const vector3<int>& iG = iGarr[n];
+	int i0 = iG[0] + S[0]/2;
+	int i1 = iG[1] + S[1]/2 + (S[0]+1);
+	int i2 = iG[2] + S[2]/2 + (S[0]+1) + (S[1]+1);
+	int tableStride = S[0] + S[1] + S[2] + 3;
+	for(int atom=0; atom<nAtoms; atom++)
+	{	const complex* t = phaseTables + atom*tableStride;
+		sf[atom*nbasis+n] = t[i0] * t[i1] * t[i2];
+	}
+}
+void structureFactor(int nbasis, int nAtoms, const vector3<int>* iGarr, const vector3<int> S, const complex* phaseTables, complex* sf);
+#ifdef GPU_ENABLED
+void structureFactor_gpu(int nbasis, int nAtoms, const vector3<int>* iGarr, const vector3<int> S, const complex* phaseTables, complex* sf);
+#endif
+
+//! Compute Vnl for a subset of the basis space and multiple atoms, given their precomputed structure factors sf (nbasis x nAtoms)
+template<int l, int m> __hostanddev__
+void VnlSF_calc(int n, int nbasis, int atomStride, int nAtoms, const vector3<>& k, const vector3<int>* iGarr,
+	const matrix3<>& G, const complex* sf, const RadialFunctionG& VnlRadial, complex* Vnl)
+{
+	vector3<> qvec = (k + iGarr[n]) * G; //k+G in cartesian coordinates
+	double q = qvec.length();
+	vector3<> qhat = qvec * (q ? 1.0/q : 0.0); //the unit vector along qvec (set qhat to 0 for q=0 (doesn't matter))
+	double prefac = Ylm<l,m>(qhat) * VnlRadial(q); //prefactor to structure factor
+	for(int atom=0; atom<nAtoms; atom++)
+		Vnl[atom*atomStride+n] = prefac * sf[atom*nbasis+n];
+}
+void Vnl(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* sf, const RadialFunctionG& VnlRadial, complex* Vnl);
+#ifdef GPU_ENABLED
+void Vnl_gpu(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* sf, const RadialFunctionG& VnlRadial, complex* Vnl);
+#endif
+
 
 //! Perform the loop:
 //!   for(lm=0; lm < Nlm; lm++) (*f)(tag< lm >);
@@ -0,0 +1,185 @@
+/*-------------------------------------------------------------------
+Copyright 2017 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/SpeciesInfo.h>
+#include <electronic/SpeciesInfo_internal.h>
+#include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
+#include <core/Operators.h>
+#include <core/matrix.h>
+#include <algorithm>
+
+//Real-space nonlocal projectors: the projectors of each atom are transformed to the real-space grid
+//and truncated to the sphere of grid points that captures all but a fraction realSpaceProjectorTol of their norm.
+//Projections and their gradients then involve one FFT per band and a local gather / scatter per atom,
+//so that the cost scales as O(N_atoms * N_sphere) per band instead of O(N_atoms * N_pw).
+
+//Minimum-image distance of each grid point from a given position (in lattice coordinates):
+inline void gridDistances(const GridInfo& gInfo, const vector3<>& pos, std::vector<double>& dist)
+{	dist.resize(gInfo.nr);
+	vector3<> invS(1./gInfo.S[0], 1./gInfo.S[1], 1./gInfo.S[2]);
+	size_t i = 0;
+	vector3<int> iv;
+	for(iv[0]=0; iv[0]<gInfo.S[0]; iv[0]++)
+	for(iv[1]=0; iv[1]<gInfo.S[1]; iv[1]++)
+	for(iv[2]=0; iv[2]<gInfo.S[2]; iv[2]++)
+	{	vector3<> x;
+		for(int k=0; k<3; k++)
+		{	x[k] = iv[k]*invS[k] - pos[k];
+			x[k] -= floor(0.5 + x[k]); //wrap to [-0.5,0.5)
+		}
+		dist[i++] = (gInfo.R * x).length();
+	}
+}
+
+bool SpeciesInfo::useRealSpaceProjectors(const ColumnBundle& Cq) const
+{	return e->cntrl.realSpaceProjectors && (!Cq.isSpinor()) && MnlAll.nRows() && atpos.size();
+}
+
+std::shared_ptr<SpeciesInfo::RealSpaceProjectors> SpeciesInfo::getVreal(const ColumnBundle& Cq) const
+{	const QuantumNumber& qnum = *(Cq.qnum);
+	const Basis& basis = *(Cq.basis);
+	const GridInfo& gInfo = *(basis.gInfo);
+	std::pair<vector3<>,const Basis*> cacheKey = std::make_pair(qnum.k, &basis);
+	{	std::lock_guard<std::mutex> lock(cacheLock);
+		auto iter = cachedVreal.find(cacheKey);
+		if(iter != cachedVreal.end()) return iter->second; //found in cache
+	}
+
+	static StopWatch watch("getVreal"); watch.start();
+	int nProj = MnlAll.nRows() / e->eInfo.spinorLength();
+	auto Vreal = std::make_shared<RealSpaceProjectors>();
+	Vreal->index.resize(atpos.size());
+	Vreal->V.resize(atpos.size());
+	std::vector<double> dist;
+	double rCut = 0.;
+	for(size_t atom=0; atom<atpos.size(); atom++)
+	{	//Projectors of this atom in G-space:
+		ColumnBundle Vat(nProj, basis.nbasis, &basis, &qnum, isGpuEnabled());
+		int iProj = 0;
+		for(int l=0; l<int(VnlRadial.size()); l++)
+			for(unsigned p=0; p<VnlRadial[l].size(); p++)
+				for(int m=-l; m<=l; m++)
+				{	callPref(Vnl)(basis.nbasis, 0, 1, l, m, qnum.k, basis.iGarr.dataPref(), gInfo.G, atposManaged.dataPref()+atom, VnlRadial[l][p], Vat.dataPref()+iProj*basis.nbasis);
+					iProj++;
+				}
+		//Transform to real space:
+		std::vector<complexScalarField> Vr(nProj);
+		for(int j=0; j<nProj; j++)
+			Vr[j] = I(Vat.getColumn(j,0));
+		gridDistances(gInfo, atpos[atom], dist);
+
+		//Determine truncation radius (once per k-point, from the first atom):
+		if(!atom)
+		{	std::vector<size_t> order(gInfo.nr);
+			for(size_t i=0; i<order.size(); i++) order[i] = i;
+			std::sort(order.begin(), order.end(), [&dist](size_t i1, size_t i2) { return dist[i1] < dist[i2]; });
+			std::vector<double> normTot(nProj, 0.), normTail(nProj, 0.);
+			for(int j=0; j<nProj; j++)
+			{	const complex* VrData = Vr[j]->data();
+				for(size_t i=0; i<order.size(); i++) normTot[j] += VrData[i].norm();
+			}
+			rCut = dist[order.back()];
+			for(size_t iSorted=order.size(); iSorted>0; iSorted--) //grow the excluded tail from the outside until tolerance is exceeded
+			{	size_t i = order[iSorted-1];
+				bool exceeded = false;
+				for(int j=0; j<nProj; j++)
+				{	normTail[j] += Vr[j]->data()[i].norm();
+					if(normTail[j] > e->cntrl.realSpaceProjectorTol * normTot[j]) exceeded = true;
+				}
+				if(exceeded) { rCut = dist[i]; break; }
+			}
+		}
+
+		//Collect the grid points within the sphere:
+		std::vector<int>& index = Vreal->index[atom];
+		for(int i=0; i<gInfo.nr; i++)
+			if(dist[i] <= rCut) index.push_back(i);
+		matrix& V = Vreal->V[atom];
+		V.init(index.size(), nProj);
+		complex* Vdata = V.data();
+		for(int j=0; j<nProj; j++)
+		{	const complex* VrData = Vr[j]->data();
+			for(const int& i: index) *(Vdata++) = VrData[i];
+		}
+	}
+	{	std::lock_guard<std::mutex> lock(cacheLock);
+		((SpeciesInfo*)this)->cachedVreal[cacheKey] = Vreal;
+		if(!VrealReported)
+		{	logPrintf("Real-space projectors for species %s: rCut = %lg bohrs, %lu grid points per atom.\n",
+				name.c_str(), rCut, Vreal->index[0].size());
+			VrealReported = true;
+		}
+	}
+	watch.stop();
+	return Vreal;
+}
+
+void SpeciesInfo::RealSpaceSpheres::gather(int b, const complex* psiR)
+{	for(size_t atom=0; atom<values.size(); atom++)
+	{	const std::vector<int>& index = Vreal->index[atom];
+		complex* psiData = values[atom].data() + values[atom].index(0,b);
+		for(const int& i: index) *(psiData++) = psiR[i];
+	}
+}
+
+void SpeciesInfo::RealSpaceSpheres::scatter(int b, complex* phiR) const
+{	for(size_t atom=0; atom<values.size(); atom++)
+	{	const std::vector<int>& index = Vreal->index[atom];
+		const complex* phiData = values[atom].data() + values[atom].index(0,b);
+		for(const int& i: index) phiR[i] += *(phiData++);
+	}
+}
+
+SpeciesInfo::RealSpaceSpheres SpeciesInfo::initRealSpaceSpheres(const ColumnBundle& Cq) const
+{	RealSpaceSpheres psi;
+	psi.Vreal = getVreal(Cq);
+	psi.values.resize(atpos.size());
+	for(size_t atom=0; atom<atpos.size(); atom++)
+		psi.values[atom].init(psi.Vreal->index[atom].size(), Cq.nCols());
+	return psi;
+}
+
+matrix SpeciesInfo::projectRealSpace(const ColumnBundle& Cq, const RealSpaceSpheres& psi) const
+{	static StopWatch watch("projectRealSpace");
+	watch.start();
+	const GridInfo& gInfo = *(Cq.basis->gInfo);
+	int nBands = Cq.nCols();
+	int nProj = psi.Vreal->V[0].nCols();
+	matrix VdagC(nProj*atpos.size(), nBands);
+	for(size_t atom=0; atom<atpos.size(); atom++)
+		VdagC.set(atom*nProj,(atom+1)*nProj, 0,nBands, (1./gInfo.nr) * (dagger(psi.Vreal->V[atom]) * psi.values[atom]));
+	watch.stop();
+	return VdagC;
+}
+
+SpeciesInfo::RealSpaceSpheres SpeciesInfo::projectGradRealSpace(const matrix& HVdagCq, const ColumnBundle& Cq) const
+{	static StopWatch watch("projectGradRealSpace");
+	RealSpaceSpheres phi;
+	phi.Vreal = getVreal(Cq);
+	watch.start();
+	const GridInfo& gInfo = *(Cq.basis->gInfo);
+	int nBands = Cq.nCols();
+	int nProj = phi.Vreal->V[0].nCols();
+	phi.values.resize(atpos.size());
+	for(size_t atom=0; atom<atpos.size(); atom++)
+		phi.values[atom] = (1./gInfo.nr) * (phi.Vreal->V[atom] * HVdagCq(atom*nProj,(atom+1)*nProj, 0,nBands));
+	watch.stop();
+	return phi;
+}
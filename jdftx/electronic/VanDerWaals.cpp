@@ -53,6 +53,7 @@ inline double vdwPairEnergyAndGrad(double r, double C6, double R0, double& E_r)
 }
 
 VanDerWaals::VanDerWaals(const Everything& everything)
+: neighborList(200.) //Truncate summation at 1/r^6 < 10^-16 => r ~ 100 bohrs (with safety margin)
 {
 	logPrintf("\nInitializing van der Waals corrections\n");
 	e = &everything;
@@ -136,34 +137,25 @@ VanDerWaals::VanDerWaals(const Everything& everything)
 
 double VanDerWaals::energyAndGrad(std::vector<Atom>& atoms, const double scaleFac) const
 {
-	//Truncate summation at 1/r^6 < 10^-16 => r ~ 100 bohrs
-	vector3<bool> isTruncated = e->coulombParams.isTruncated();
-	vector3<int> n;
-	for(int k=0; k<3; k++)
-		n[k] = isTruncated[k] ? 0 : (int)ceil(200. / e->gInfo.R.column(k).length());
-	
-	double Etot = 0.;  //Total VDW Energy
-	for(int c1=0; c1<int(atoms.size()); c1++)
-	{	const AtomParams& c1params = getParams(atoms[c1].atomicNumber, atoms[c1].sp);
-		for(int c2=0; c2<int(atoms.size()); c2++)
-		{	const AtomParams& c2params = getParams(atoms[c2].atomicNumber, atoms[c2].sp);
-			double C6 = sqrt(c1params.C6 * c2params.C6);
-			double R0 = c1params.R0 + c2params.R0;
-			vector3<int> iR;
-			for(iR[0] = -n[0]; iR[0]<=n[0]; iR[0]++)
-			for(iR[1] = -n[1]; iR[1]<=n[1]; iR[1]++)
-			for(iR[2] = -n[2]; iR[2]<=n[2]; iR[2]++)
-			{	vector3<> x = iR + (atoms[c1].pos - atoms[c2].pos);
-				double rSq = e->gInfo.RTR.metric_length_squared(x);
-				if(!rSq) continue; //exclude self-interaction
-				double r = sqrt(rSq);
-				double E_r, E = vdwPairEnergyAndGrad(r, C6, R0, E_r);
-				Etot -= 0.5 * scaleFac * E;
-				atoms[c1].force += scaleFac * E_r * (e->gInfo.RTR * x)/r;
-			}
-		}
+	//Collect positions and parameters:
+	std::vector< vector3<> > pos(atoms.size());
+	std::vector<AtomParams> params(atoms.size());
+	for(size_t c=0; c<atoms.size(); c++)
+	{	pos[c] = atoms[c].pos;
+		params[c] = getParams(atoms[c].atomicNumber, atoms[c].sp);
 	}
-	return Etot;
+	
+	//Sum over pairs within cutoff (see constructor) using cell list:
+	neighborList.update(e->gInfo.R, pos, e->coulombParams.isTruncated());
+	const matrix3<>& RTR = e->gInfo.RTR;
+	return neighborList.pairSum(pos, [&](int c1, int c2, vector3<> x, double rSq)
+	{	double C6 = sqrt(params[c1].C6 * params[c2].C6);
+		double R0 = params[c1].R0 + params[c2].R0;
+		double r = sqrt(rSq);
+		double E_r, E = vdwPairEnergyAndGrad(r, C6, R0, E_r);
+		atoms[c1].force += scaleFac * E_r * (RTR * x)/r;
+		return -0.5 * scaleFac * E;
+	});
 }
 
 
@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/RadialFunction.h>
 #include <core/ScalarFieldArray.h>
 #include <core/Coulomb.h>
+#include <core/NeighborList.h>
 
 //! @addtogroup LongRange
 //! @{
@@ -65,6 +66,7 @@ private:
 	
 	std::vector<AtomParams> atomParams; //!< List of C6 coeficients and radii R0 for all atoms
 	std::map<string,double> scalingFactor; //!< ExCorr dependent scale factor
+	mutable NeighborList neighborList; //!< cell list for the pair sum between discrete atoms
 	
 	//! Get cached RadialFunctionG for interaction kernel between species of
 	//! atomic numnbers Z1 and Z2. The radial function will be created (and cached)
@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <fluid/Fex_LJ.h>
 #include <core/Units.h>
 #include <core/Operators.h>
+#include <core/Simd.h>
 
 string rigidMoleculeCDFT_ScalarEOSpaper = "R. Sundararaman and T.A. Arias, arXiv:1302.0026";
 
@@ -91,8 +92,8 @@ double JeffereyAustinEOS::vdwRadius() const
 {	return eval->vdwRadius();
 }
 
-void evalJeffereyAustinEOS_sub(size_t iStart, size_t iStop, const double* N, double* Aex, double* Aex_N, double Vhs, const JeffereyAustinEOS_eval& eval)
-{	for(size_t i=iStart; i<iStop; i++) eval(i, N, Aex, Aex_N, Vhs);
+void evalJeffereyAustinEOS_sub(size_t iStart, size_t iStop, const double* __restrict__ N, double* __restrict__ Aex, double* __restrict__ Aex_N, double Vhs, const JeffereyAustinEOS_eval& eval)
+{	SIMD_LOOP for(size_t i=iStart; i<iStop; i++) eval(i, N, Aex, Aex_N, Vhs);
 }
 void JeffereyAustinEOS::evaluate(size_t nData, const double* N, double* Aex, double* Aex_N, double Vhs) const
 {	threadLaunch(evalJeffereyAustinEOS_sub, nData, N, Aex, Aex_N, Vhs, *eval);
@@ -115,8 +116,8 @@ double TaoMasonEOS::vdwRadius() const
 {	return eval->vdwRadius();
 }
 
-void evalTaoMasonEOS_sub(size_t iStart, size_t iStop, const double* N, double* Aex, double* Aex_N, double Vhs, const TaoMasonEOS_eval& eval)
-{	for(size_t i=iStart; i<iStop; i++) eval(i, N, Aex, Aex_N, Vhs);
+void evalTaoMasonEOS_sub(size_t iStart, size_t iStop, const double* __restrict__ N, double* __restrict__ Aex, double* __restrict__ Aex_N, double Vhs, const TaoMasonEOS_eval& eval)
+{	SIMD_LOOP for(size_t i=iStart; i<iStop; i++) eval(i, N, Aex, Aex_N, Vhs);
 }
 void TaoMasonEOS::evaluate(size_t nData, const double* N, double* Aex, double* Aex_N, double Vhs) const
 {	threadLaunch(evalTaoMasonEOS_sub, nData, N, Aex, Aex_N, Vhs, *eval);
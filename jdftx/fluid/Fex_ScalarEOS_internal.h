@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/Units.h>
 #include <core/scalar.h>
+#include <core/Simd.h>
 
 //! @addtogroup ClassicalDFT
 //! @{
@@ -36,10 +37,19 @@ struct ScalarEOS_eval
 	}
 	
 	__hostanddev__ double getAhs(double N, double& Ahs_N, double Vhs) const
-	{	double n3 = Vhs*N; if(n3 >= 1.) { Ahs_N = NAN; return NAN; }
+	{
+		#ifdef SIMD_BRANCHFREE
+		double n3 = Vhs*N; bool overPacked = (n3 >= 1.);
+		double den = 1./(1-n3);
+		double Ahs = T * (den*den)*n3*(4-3*n3); //corresponds to Carnahan-Starling EOS
+		Ahs_N = overPacked ? NAN : T*Vhs * (den*den*den)*2*(2-n3);
+		return overPacked ? NAN : Ahs;
+		#else
+		double n3 = Vhs*N; if(n3 >= 1.) { Ahs_N = NAN; return NAN; }
 		double den = 1./(1-n3);
 		Ahs_N = T*Vhs * (den*den*den)*2*(2-n3);
 		return T * (den*den)*n3*(4-3*n3); //corresponds to Carnahan-Starling EOS
+		#endif
 	}
 };
 
@@ -101,8 +111,28 @@ struct JeffereyAustinEOS_eval : public ScalarEOS_eval
 	}
 	
 	//Compute the per-particle free energies at each grid point, and the gradient w.r.t the weighted density
-	__hostanddev__ void operator()(int i, const double* Nbar, double* Aex, double* Aex_Nbar, double Vhs) const
+	__hostanddev__ void operator()(size_t i, const double* Nbar, double* Aex, double* Aex_Nbar, double Vhs) const
 	{
+		#ifdef SIMD_BRANCHFREE
+		//Branch-free: all terms are evaluated and the special cases selected at the end, so that CPU loops vectorize
+		double N = Nbar[i];
+		//HB part:
+		double gaussHB = exp(pow((N-nHB)/dnHB,2));
+		double fHBden = C1 + gaussHB;
+		double fHBdenPrime = gaussHB * 2*(N-nHB)/pow(dnHB,2);
+		double AHB = prefacHB / fHBden;
+		double AHB_Nbar = -AHB * fHBdenPrime/fHBden;
+		//VW part:
+		double Ginv = 1 - lambda*b*N;
+		double VPphiInt_Nbar, VPphiInt = getVPphiInt(N, VPphiInt_Nbar);
+		double AVW = prefacVW1*log(Ginv) + (VPzi*VPphiInt -  N)*prefacVW2;
+		double AVW_Nbar = T*alpha/Ginv + (VPzi*VPphiInt_Nbar - 1.) * prefacVW2;
+		//FMT part:
+		double AFMT_Nbar, AFMT = getAhs(N, AFMT_Nbar, Vhs);
+		//Total (zero for negative densities, NAN beyond the pole of the VW term):
+		Aex_Nbar[i] = (N<0.) ? 0. : ((Ginv<=0.) ? NAN : AHB_Nbar + AVW_Nbar - AFMT_Nbar);
+		Aex[i] = (N<0.) ? 0. : ((Ginv<=0.) ? NAN : AHB + AVW - AFMT);
+		#else
 		if(Nbar[i]<0.)
 		{	Aex[i] = 0.;
 			Aex_Nbar[i] = 0.;
@@ -124,6 +154,7 @@ struct JeffereyAustinEOS_eval : public ScalarEOS_eval
 		//Total
 		Aex_Nbar[i] = AHB_Nbar + AVW_Nbar - AFMT_Nbar;
 		Aex[i] = AHB + AVW - AFMT;
+		#endif
 	}
 };
 
@@ -156,8 +187,26 @@ struct TaoMasonEOS_eval : public ScalarEOS_eval
 	}
 	
 	//Compute the per-particle free energies at each grid point, and the gradient w.r.t the weighted density
-	__hostanddev__ void operator()(int i, const double* Nbar, double* Aex, double* Aex_Nbar, double Vhs) const
+	__hostanddev__ void operator()(size_t i, const double* Nbar, double* Aex, double* Aex_Nbar, double Vhs) const
 	{
+		#ifdef SIMD_BRANCHFREE
+		//Branch-free: all terms are evaluated and the special cases selected at the end, so that CPU loops vectorize
+		double N = Nbar[i];
+		//VW part:
+		double Ginv = 1 - lambda*b*N;
+		double AVW = N*prefacQuad + prefacPole*(-log(Ginv));
+		double AVW_Nbar = prefacQuad + prefacPole*(lambda*b/Ginv);
+		//Vapor pressure correction:
+		double b2term = sqrt(1.8)*b*b;
+		double bn2term = b2term*N*N;
+		double Avap = prefacVap * atan(bn2term);
+		double Avap_Nbar = prefacVap * b2term*N*2. / (1 + bn2term*bn2term);
+		//FMT part:
+		double AFMT_Nbar, AFMT = getAhs(N, AFMT_Nbar, Vhs);
+		//Total (zero for negative densities, NAN beyond the pole of the VW term):
+		Aex_Nbar[i] = (N<0.) ? 0. : ((Ginv<=0.) ? NAN : AVW_Nbar + Avap_Nbar - AFMT_Nbar);
+		Aex[i] = (N<0.) ? 0. : ((Ginv<=0.) ? NAN : AVW + Avap - AFMT);
+		#else
 		if(Nbar[i]<0.)
 		{	Aex[i] = 0.;
 			Aex_Nbar[i] = 0.;
@@ -177,6 +226,7 @@ struct TaoMasonEOS_eval : public ScalarEOS_eval
 		//Total
 		Aex_Nbar[i] = AVW_Nbar + Avap_Nbar - AFMT_Nbar;
 		Aex[i] = AVW + Avap - AFMT;
+		#endif
 	}
 };
 
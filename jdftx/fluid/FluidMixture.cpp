@@ -226,6 +226,9 @@ void FluidMixture::initState(double scale, double Elo, double Ehi)
 void FluidMixture::loadState(const char* filename)
 {	nullToZero(state, gInfo, get_nIndep());
 	loadFromFile(state, filename);
+	//Restore symmetries assumed by reduced orientation sampling (file may be from a run with different symmetries):
+	for(const FluidComponent* c: component)
+		c->idealGas->symmetrizeState(&state[c->offsetIndep]);
 }
 
 void FluidMixture::saveState(const char* filename) const
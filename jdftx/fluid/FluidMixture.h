@@ -39,6 +39,7 @@ public:
 	const double T; //!< Temperature
 	bool verboseLog; //!< print energy components etc. if enabled (off by default)
 	vector3<> Eexternal; //!< External uniform electric field
+	std::vector<SpaceGroupOp> sym; //!< Space group of the external potentials (if set before adding components, used to reduce orientation sampling)
 
 	FluidMixture(const GridInfo& gInfo, const double T=298*Kelvin);
 	virtual ~FluidMixture();
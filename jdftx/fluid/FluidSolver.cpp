@@ -78,6 +78,9 @@ public:
 		//Initialize fluid mixture:
 		fluidMixture = new FluidMixtureJDFT(e, gInfo, fsp.T);
 		fluidMixture->verboseLog = fsp.verboseLog;
+		//Potentials from the electronic system are symmetrized, so its symmetries may be used to reduce orientation sampling:
+		if(e.symm.mode != SymmetriesNone && &gInfo == &e.gInfo)
+			fluidMixture->sym = e.symm.getMatrices();
 		
 		//Add the fluid components:
 		for(const auto& c: fsp.components)
@@ -162,6 +165,14 @@ public:
 	void saveState(const char* filename) const
 	{	fluidMixture->saveState(filename);
 	}
+	
+	ScalarFieldArray getStateArray() const
+	{	return clone(fluidMixture->state);
+	}
+	
+	void setStateArray(const ScalarFieldArray& state)
+	{	fluidMixture->state = clone(state);
+	}
 
 	void dumpDensities(const char* filenamePattern) const
 	{	
@@ -314,7 +325,8 @@ double FluidSolver::ionWidthMuCorrection() const
 }
 
 void FluidSolver::set(const ScalarFieldTilde& rhoExplicitTilde, const ScalarFieldTilde& nCavityTilde)
-{	for(unsigned iSp=0; iSp<atpos.size(); iSp++)
+{	if(fsp.nStateHistory) extrapolateState();
+	for(unsigned iSp=0; iSp<atpos.size(); iSp++)
 		atpos[iSp] = e.iInfo.species[iSp]->atpos;
 	if(e.coulombParams.embed)
 	{	matrix3<> embedScaleMat = Diag(e.coulomb->embedScale); //lattice coordinate scale factor due to embedding
@@ -327,6 +339,73 @@ void FluidSolver::set(const ScalarFieldTilde& rhoExplicitTilde, const ScalarFiel
 		set_internal(rhoExplicitTilde, nCavityTilde);
 }
 
+//Warm-start of the fluid state across ionic steps: find coefficients c_k (summing to 1) that best reproduce
+//the current atomic positions as a combination of those in the history, and combine the states with the same
+//coefficients. With two entries, this reduces to linear extrapolation along the direction of atomic displacement.
+void FluidSolver::extrapolateState()
+{	static StopWatch watch("FluidSolver::extrapolateState");
+	//Collect current positions and check whether ions have moved:
+	std::vector< vector3<> > pos;
+	for(const auto& sp: e.iInfo.species)
+		pos.insert(pos.end(), sp->atpos.begin(), sp->atpos.end());
+	if(posPrev.size() != pos.size()) { posPrev = pos; return; } //first call
+	auto cartesianDiff = [&](const vector3<>& x1, const vector3<>& x2)
+	{	vector3<> dx = x1 - x2;
+		for(int k=0; k<3; k++) dx[k] -= floor(0.5 + dx[k]); //minimum image
+		return e.gInfo.R * dx;
+	};
+	double dPosSq = 0.;
+	for(size_t i=0; i<pos.size(); i++)
+		dPosSq += cartesianDiff(pos[i], posPrev[i]).length_squared();
+	if(dPosSq < 1e-16) return; //ions have not moved
+	watch.start();
+	//Record the state at the previous positions:
+	ScalarFieldArray stateCur = getStateArray();
+	if(!stateCur.size()) { posPrev = pos; stateHistory.clear(); watch.stop(); return; } //not initialized or unsupported
+	stateHistory.push_back(StateHistoryEntry());
+	stateHistory.back().pos = posPrev;
+	stateHistory.back().state = stateCur;
+	while(int(stateHistory.size()) > fsp.nStateHistory) stateHistory.pop_front();
+	posPrev = pos;
+	int nHist = stateHistory.size();
+	if(nHist < 2) { watch.stop(); return; } //current state is the best guess
+	//Least-squares fit for coefficients relative to the most recent entry:
+	const std::vector< vector3<> >& posLast = stateHistory.back().pos;
+	int n = nHist-1;
+	matrix A(n,n), b(n,1);
+	for(int k1=0; k1<n; k1++)
+	{	for(int k2=0; k2<=k1; k2++)
+		{	double Aij = 0.;
+			for(size_t i=0; i<pos.size(); i++)
+				Aij += dot(cartesianDiff(stateHistory[k1].pos[i], posLast[i]), cartesianDiff(stateHistory[k2].pos[i], posLast[i]));
+			A.set(k1,k2, Aij);
+			A.set(k2,k1, Aij);
+		}
+		double bi = 0.;
+		for(size_t i=0; i<pos.size(); i++)
+			bi += dot(cartesianDiff(stateHistory[k1].pos[i], posLast[i]), cartesianDiff(pos[i], posLast[i]));
+		b.set(k1,0, bi);
+	}
+	double Atrace = trace(A).real();
+	if(Atrace < 1e-16) { watch.stop(); return; } //degenerate history
+	for(int k=0; k<n; k++) A.set(k,k, A(k,k) + 1e-8*Atrace); //regularize nearly-collinear histories
+	matrix c = inv(A) * b;
+	//Combine states:
+	ScalarFieldArray stateNew = clone(stateHistory.back().state);
+	double cLast = 1.;
+	logPrintf("Extrapolating fluid state from %d previous ionic steps with coefficients [", nHist);
+	for(int k=0; k<n; k++)
+	{	double ck = c(k,0).real();
+		axpy(ck, stateHistory[k].state, stateNew);
+		axpy(-ck, stateHistory.back().state, stateNew);
+		cLast -= ck;
+		logPrintf(" %lg", ck);
+	}
+	logPrintf(" %lg ]\n", cLast);
+	setStateArray(stateNew);
+	watch.stop();
+}
+
 double FluidSolver::get_Adiel_and_grad(ScalarFieldTilde* Adiel_rhoExplicitTilde, ScalarFieldTilde* Adiel_nCavityTilde, IonicGradient* extraForces, bool electricOnly) const
 {	if(e.coulombParams.embed)
 	{	ScalarFieldTilde Adiel_rho_big, Adiel_n_big;
@@ -25,8 +25,10 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 //! @file FluidSolver.h Common interface for all the fluids to the electronic code
 
 #include <core/ScalarField.h>
+#include <core/ScalarFieldArray.h>
 #include <fluid/FluidSolverParams.h>
 #include <electronic/IonicMinimizer.h>
+#include <deque>
 
 //! Abstract base class for the fluid solvers
 struct FluidSolver
@@ -90,12 +92,29 @@ struct FluidSolver
 	//! Minimize fluid side (holding explicit electronic system fixed)
 	virtual void minimizeFluid()=0;
 	
+	//! Get a copy of the fluid state as real-space fields, for warm-start extrapolation across ionic steps.
+	//! Return an empty array if the state is not yet initialized (or extrapolation is unsupported, which is the default).
+	virtual ScalarFieldArray getStateArray() const { return ScalarFieldArray(); }
+	
+	//! Set the fluid state from fields in the format returned by getStateArray()
+	virtual void setStateArray(const ScalarFieldArray& state) {}
+	
 protected:
 	//! Fluid-dependent implementation of set()
 	virtual void set_internal(const ScalarFieldTilde& rhoExplicitTilde, const ScalarFieldTilde& nCavityTilde)=0;
 
 	//! Fluid-dependent implementation of get_Adiel_and_grad()
 	virtual double get_Adiel_and_grad_internal(ScalarFieldTilde& Adiel_rhoExplicitTilde, ScalarFieldTilde& Adiel_nCavityTilde, IonicGradient* extraForces, bool electricOnly) const =0;
+
+private:
+	//! Fluid state at a previous ionic configuration
+	struct StateHistoryEntry
+	{	std::vector< vector3<> > pos; //!< atomic positions (lattice coordinates, all species)
+		ScalarFieldArray state; //!< converged fluid state at those positions
+	};
+	std::deque<StateHistoryEntry> stateHistory; //!< most recent last, at most FluidSolverParams::nStateHistory entries
+	std::vector< vector3<> > posPrev; //!< atomic positions at previous call to set()
+	void extrapolateState(); //!< if ions moved since the previous set(), record the state and extrapolate to the new positions
 };
 
 //! Create and return a JDFTx solver (the solver can be freed using delete)
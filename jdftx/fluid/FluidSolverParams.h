@@ -135,6 +135,9 @@ struct FluidSolverParams
 	bool nonlinearSCF; //!< whether to use an SCF method for nonlinear PCMs
 	double screenOverride; //! overrides screening factor with this value
 	PulayParams scfParams; //!< parameters controlling Pulay mixing for SCF version of nonlinear PCM
+	bool cavityPreconditioner; //!< whether to use the cavity-aware (rather than bulk) preconditioner for PCM inner solves
+	
+	int nStateHistory; //!< number of previous fluid states (at previous ionic positions) used to extrapolate the initial fluid state (0 => disabled)
 	
 	//For Explicit Fluid JDFT alone:
 	ExCorr exCorr; //!< Fluid exchange-correlation and kinetic energy functional
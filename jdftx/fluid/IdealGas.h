@@ -64,6 +64,10 @@ public:
 	//! Nscale will be the same as in compute()
 	virtual void convertGradients(const ScalarField* indep, const ScalarField* N, const ScalarField* Phi_N, const vector3<>& Phi_P0, ScalarField* Phi_indep, const double Nscale) const=0;
 
+	//! Project indep onto the subspace assumed by this representation (eg. symmetrize it when orientation
+	//! sampling is reduced by symmetry); used for states that were not generated by initState, such as those loaded from file
+	virtual void symmetrizeState(ScalarField* indep) const {}
+
 	double get_Nbulk();
 
 	//! Override the values for bulk density and chemical potential set by fluidMixture::initialize()
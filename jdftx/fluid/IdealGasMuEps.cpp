@@ -31,9 +31,9 @@ string IdealGasMuEps::representationName() const
 
 void IdealGasMuEps::initState_o(int o, const matrix3<>& rot, double scale, const ScalarField& Eo, ScalarField* mueps) const
 {	vector3<> pVec = rot * pMol;
-	mueps[0] += (-quad.weight(o)*scale/T) * Eo;
+	mueps[0] += (-weight(o)*scale/T) * Eo;
 	for(int k=0; k<3; k++)
-		mueps[k+1] += (-pVec[k]*quad.weight(o)*scale/T) * Eo;
+		mueps[k+1] += (-pVec[k]*weight(o)*scale/T) * Eo;
 }
 
 void IdealGasMuEps::getDensities_o(int o, const matrix3<>& rot, const ScalarField* mueps, ScalarField& logPomega_o) const
@@ -49,3 +49,8 @@ void IdealGasMuEps::convertGradients_o(int o, const matrix3<>& rot, const Scalar
 	for(int k=0; k<3; k++)
 		Phi_mueps[k+1] += pVec[k] * Phi_logPomega_o;
 }
+
+void IdealGasMuEps::symmetrizeState(ScalarField* mueps) const
+{	symmetrize(mueps[0]);
+	symmetrizeVector(mueps+1);
+}
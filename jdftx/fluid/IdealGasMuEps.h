@@ -38,6 +38,7 @@ protected:
 	void initState_o(int o, const matrix3<>& rot, double scale, const ScalarField& Eo, ScalarField* mueps) const;
 	void getDensities_o(int o, const matrix3<>& rot, const ScalarField* mueps, ScalarField& logPomega_o) const;
 	void convertGradients_o(int o, const matrix3<>& rot, const ScalarField& Phi_logPomega_o, ScalarField* Phi_mueps) const;
+	void symmetrizeState(ScalarField* mueps) const;
 };
 
 //! @}
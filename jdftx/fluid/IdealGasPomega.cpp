@@ -18,12 +18,155 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 -------------------------------------------------------------------*/
 
 #include <fluid/IdealGasPomega.h>
+#include <fluid/FluidMixture.h>
 #include <fluid/Euler.h>
+#include <core/LoopMacros.h>
+#include <atomic>
 
 IdealGasPomega::IdealGasPomega(const FluidMixture* fluidMixture, const FluidComponent* comp, const SO3quad& quad, const TranslationOperator& trans, unsigned nIndepOverride)
-: IdealGas(nIndepOverride ? nIndepOverride : quad.nOrientations(), fluidMixture, comp), quad(quad), trans(trans), pMol(molecule.getDipole())
+: IdealGas(nIndepOverride ? nIndepOverride : quad.nOrientations(), fluidMixture, comp), quad(quad), trans(trans), pMol(molecule.getDipole()),
+oMult(quad.nOrientations(), 1.)
+{
+	setupSymmetries(fluidMixture->sym);
+	//Divide the inequivalent orientations between processes:
+	std::vector<int> oReduced;
+	for(int o=0; o<quad.nOrientations(); o++)
+		if(oMult[o]) oReduced.push_back(o);
+	int jStart, jStop;
+	TaskDivision(oReduced.size(), mpiUtil).myRange(jStart, jStop);
+	oMine.assign(oReduced.begin()+jStart, oReduced.begin()+jStop);
+}
+
+//Orientation sampling under space group symmetries of the external potentials:
+//if the potentials are invariant under r -> rot r + a, then the orientation density satisfies
+//Pomega_{rot o}(rot r + a) = Pomega_o(r), so the site densities from an orbit of orientations
+//equal those of any one member, symmetrized and multiplied by the orbit size.
+//Only proper rotations that map the grid and the quadrature onto themselves are used (these form a subgroup).
+void IdealGasPomega::setupSymmetries(const std::vector<SpaceGroupOp>& sym)
+{	if(sym.size() <= 1) return;
+	const double tol = 1e-6;
+	int nO = quad.nOrientations();
+	//Site positions of each orientation:
+	std::vector< std::vector< std::vector< vector3<> > > > images(nO, std::vector< std::vector< vector3<> > >(molecule.sites.size()));
+	for(int o=0; o<nO; o++)
+	{	matrix3<> rot = matrixFromEuler(quad.euler(o));
+		for(unsigned i=0; i<molecule.sites.size(); i++)
+			for(vector3<> pos: molecule.sites[i]->positions)
+				images[o][i].push_back(rot * pos);
+	}
+	//Check if rotated site positions of orientation o match those of orientation o2:
+	auto matches = [&](const matrix3<>& Rcart, int o, int o2)
+	{	if(fabs(quad.weight(o)-quad.weight(o2)) > tol*quad.weight(o)) return false;
+		for(unsigned i=0; i<molecule.sites.size(); i++)
+			for(const vector3<>& pos: images[o][i])
+			{	vector3<> posRot = Rcart * pos;
+				bool found = false;
+				for(const vector3<>& pos2: images[o2][i])
+					if((posRot - pos2).length_squared() < tol*tol) { found = true; break; }
+				if(!found) return false;
+			}
+		return true;
+	};
+	//Select symmetries and compute orientation map under each:
+	std::vector< std::vector<int> > oMap; //image of each orientation under each selected symmetry
+	for(const SpaceGroupOp& op: sym)
+	{	//Proper rotations only:
+		if(det(op.rot) != 1) continue;
+		//Check commensurate with grid:
+		matrix3<> rotMesh = Diag(vector3<>(gInfo.S)) * matrix3<>(op.rot) * inv(Diag(vector3<>(gInfo.S)));
+		vector3<> aMesh = Diag(vector3<>(gInfo.S)) * op.a;
+		matrix3<int> rotMeshInt; vector3<int> aMeshInt;
+		double err = 0.;
+		for(int j=0; j<3; j++)
+		{	aMeshInt[j] = int(round(aMesh[j])); err += fabs(aMesh[j] - aMeshInt[j]);
+			for(int k=0; k<3; k++)
+			{	rotMeshInt(j,k) = int(round(rotMesh(j,k))); err += fabs(rotMesh(j,k) - rotMeshInt(j,k));
+			}
+		}
+		if(err > tol) continue;
+		//Check quadrature closed under rotation:
+		matrix3<> Rcart = gInfo.R * matrix3<>(op.rot) * inv(gInfo.R);
+		std::vector<int> oMapCur(nO, -1);
+		bool closed = true;
+		for(int o=0; o<nO && closed; o++)
+		{	for(int o2=0; o2<nO; o2++)
+				if(matches(Rcart, o, o2)) { oMapCur[o] = o2; break; }
+			if(oMapCur[o] < 0) closed = false;
+		}
+		if(!closed) continue;
+		symMesh.push_back(rotMeshInt);
+		symOffset.push_back(aMeshInt);
+		symCart.push_back(Rcart);
+		oMap.push_back(oMapCur);
+	}
+	if(symMesh.size() <= 1)
+	{	symMesh.clear(); symOffset.clear(); symCart.clear();
+		return;
+	}
+	//Collect orbits, represented by their lowest orientation index:
+	std::vector<int> orbit(nO, -1);
+	int nReduced = 0;
+	for(int o=0; o<nO; o++)
+		if(orbit[o] < 0)
+		{	for(const std::vector<int>& oMapCur: oMap)
+				orbit[oMapCur[o]] = o;
+			nReduced++;
+		}
+	oMult.assign(nO, 0.);
+	for(int o=0; o<nO; o++)
+		oMult[orbit[o]] += 1.;
+	logPrintf("\tIdealGas[%s]: reduced to %d inequivalent orientations of %d using %d symmetries.\n",
+		molecule.name.c_str(), nReduced, nO, int(symMesh.size()));
+}
+
+//Wrap a mesh index into the first cell:
+inline int wrappedMeshIndex(const vector3<int>& iv, const vector3<int>& S)
+{	vector3<int> ivWrapped;
+	for(int k=0; k<3; k++)
+	{	ivWrapped[k] = iv[k] % S[k];
+		if(ivWrapped[k] < 0) ivWrapped[k] += S[k];
+	}
+	return ivWrapped[2] + S[2]*(ivWrapped[1] + S[1]*ivWrapped[0]);
+}
+
+void symmetrize_sub(size_t iStart, size_t iStop, const vector3<int> S, const std::vector< matrix3<int> >* symMesh,
+	const std::vector< vector3<int> >* symOffset, const std::vector< matrix3<> >* symCart, int nComponents, const double* const* x, double* const* xSym)
+{	double invN = 1./symMesh->size();
+	THREAD_rLoop(
+		vector3<> v;
+		for(size_t g=0; g<symMesh->size(); g++)
+		{	int j = wrappedMeshIndex(symMesh->at(g)*iv + symOffset->at(g), S);
+			if(nComponents == 1) v[0] += x[0][j];
+			else v += (~symCart->at(g)) * vector3<>(x[0][j], x[1][j], x[2][j]); //rotate back to the frame at r
+		}
+		for(int k=0; k<nComponents; k++) xSym[k][i] = invN * v[k];
+	)
+}
+
+void IdealGasPomega::symmetrize(ScalarField& x) const
+{	if(!symMesh.size() || !x) return;
+	ScalarField xSym; nullToZero(xSym, gInfo);
+	const double* xData = x->data();
+	double* xSymData = xSym->data();
+	threadLaunch(symmetrize_sub, gInfo.nr, gInfo.S, &symMesh, &symOffset, &symCart, 1, &xData, &xSymData);
+	x = xSym;
+}
+
+void IdealGasPomega::symmetrizeVector(ScalarField* x) const
+{	if(!symMesh.size()) return;
+	ScalarField xSym[3]; const double* xData[3]; double* xSymData[3];
+	for(int k=0; k<3; k++)
+	{	nullToZero(x[k], gInfo);
+		nullToZero(xSym[k], gInfo);
+		xData[k] = x[k]->data();
+		xSymData[k] = xSym[k]->data();
+	}
+	threadLaunch(symmetrize_sub, gInfo.nr, gInfo.S, &symMesh, &symOffset, &symCart, 3, xData, xSymData);
+	for(int k=0; k<3; k++) x[k] = xSym[k];
+}
+
+void IdealGasPomega::symmetrizeState(ScalarField* state) const
 {
-	TaskDivision(quad.nOrientations(), mpiUtil).myRange(oStart, oStop);
 }
 
 string IdealGasPomega::representationName() const
@@ -51,15 +194,17 @@ void IdealGasPomega::initState(const ScalarField* Vex, ScalarField* indep, doubl
 		Veff[i] += Vex[i];
 	}
 	double Emin=+DBL_MAX, Emax=-DBL_MAX, Emean=0.0;
-	for(int o=oStart; o<oStop; o++)
+	for(int o: oMine)
 	{	matrix3<> rot = matrixFromEuler(quad.euler(o));
 		ScalarField Emolecule;
 		//Sum the potentials collected over sites for each orientation:
+		std::vector<TaxpyTerm> terms;
 		for(unsigned i=0; i<molecule.sites.size(); i++)
 			for(vector3<> pos: molecule.sites[i]->positions)
-				trans.taxpy(-(rot*pos), 1., Veff[i], Emolecule);
+				terms.push_back(TaxpyTerm(-(rot*pos), 1., i, 0));
+		trans.taxpyBatch(terms, Veff.data(), &Emolecule);
 		//Accumulate stats and cap:
-		Emean += quad.weight(o) * sum(Emolecule)/gInfo.nr;
+		Emean += weight(o) * sum(Emolecule)/gInfo.nr;
 		double Emin_o, Emax_o;
 		callPref(eblas_capMinMax)(gInfo.nr, Emolecule->dataPref(), Emin_o, Emax_o, Elo, Ehi);
 		if(Emin_o<Emin) Emin=Emin_o;
@@ -69,6 +214,7 @@ void IdealGasPomega::initState(const ScalarField* Vex, ScalarField* indep, doubl
 	}
 	//MPI collect:
 	for(int k=0; k<nIndep; k++) { nullToZero(indep[k],gInfo); indep[k]->allReduce(MPIUtil::ReduceSum); }
+	symmetrizeState(indep);
 	mpiUtil->allReduce(Emin, MPIUtil::ReduceMin);
 	mpiUtil->allReduce(Emax, MPIUtil::ReduceMax);
 	mpiUtil->allReduce(Emean, MPIUtil::ReduceSum);
@@ -77,32 +223,100 @@ void IdealGasPomega::initState(const ScalarField* Vex, ScalarField* indep, doubl
 		   representationName().c_str(), molecule.name.c_str(), Emin, Emax, Emean);
 }
 
+//Orientations are processed in parallel on threads, each of which picks up orientations dynamically
+//and accumulates to its own outputs (summed at the end), reusing its work buffers across orientations.
+//Operator threading is suspended within, so the translations of each orientation run serially per thread.
+//Each thread holds nGridsPerThread full grids, so the thread count is limited to keep their total within
+//the larger of the state size (nIndep grids) and a fixed budget; on large grids this falls back to fewer
+//orientation threads, down to a single one in which the operators of each orientation are threaded instead.
+inline int orientationThreads(int nOrientations, int nGridsPerThread, int nIndep, const GridInfo& gInfo)
+{	if(isGpuEnabled()) return 1;
+	const double threadMemory = 256.*1024*1024; //bytes of per-thread grids allowed irrespective of state size
+	double nGridsMax = std::max(double(nIndep), threadMemory/(gInfo.nr*sizeof(double)));
+	int nThreadsMax = int(nGridsMax / nGridsPerThread);
+	return std::max(1, std::min(std::min(nProcsAvailable, nOrientations), nThreadsMax));
+}
+
+//Sum per-thread accumulators into the first (skipping null entries):
+inline void sumThreads(std::vector<ScalarFieldArray>& xt, ScalarField* x, int n)
+{	for(int k=0; k<n; k++)
+	{	x[k] = xt[0][k];
+		for(size_t t=1; t<xt.size(); t++)
+			if(xt[t][k]) x[k] += xt[t][k];
+	}
+}
+
 void IdealGasPomega::getDensities(const ScalarField* indep, ScalarField* N, vector3<>& P0) const
-{	for(unsigned i=0; i<molecule.sites.size(); i++) N[i]=0;
+{	static StopWatch watch("IdealGasPomega::getDensities"); watch.start();
+	unsigned nSites = molecule.sites.size();
+	bool hasDipole = pMol.length_squared();
+	int nThreads = orientationThreads(oMine.size(), nSites + (hasDipole ? 5 : 2), nIndep, gInfo); //site and polarization densities, and work buffers
+	std::vector<ScalarFieldArray> Nt(nThreads, ScalarFieldArray(nSites)); //per-thread site densities
+	std::vector<VectorField> Pt(nThreads); //per-thread polarization densities
+	std::vector<double> St(nThreads, 0.); //per-thread entropy
+	std::atomic<int> jNext(0);
+	auto processOrientations = [&](int iThread, int nThreads)
+	{	ScalarField logPomega_o, N_o; nullToZero(N_o, gInfo);
+		std::vector<TaxpyTerm> terms;
+		VectorField& P = Pt[iThread];
+		if(hasDipole) nullToZero(P, gInfo);
+		for(int j=jNext++; j<int(oMine.size()); j=jNext++)
+		{	int o = oMine[j];
+			matrix3<> rot = matrixFromEuler(quad.euler(o));
+			if(logPomega_o) logPomega_o->zero();
+			getDensities_o(o, rot, indep, logPomega_o);
+			//Contribution to density, entropy and polarization from this orientation (fused in a single pass):
+			double prefac = weight(o) * Nbulk;
+			vector3<> pRot = rot * pMol;
+			#ifdef GPU_ENABLED
+			N_o = prefac * exp(logPomega_o);
+			St[iThread] += gInfo.dV*dot(N_o, logPomega_o);
+			if(hasDipole) P += pRot * N_o;
+			#else
+			const double* logPdata = logPomega_o->data();
+			double* Ndata = N_o->data();
+			double Ssum = 0.;
+			if(hasDipole)
+			{	double* Pdata[3]; for(int k=0; k<3; k++) Pdata[k] = P[k]->data();
+				for(int i=0; i<gInfo.nr; i++)
+				{	Ndata[i] = prefac * exp(logPdata[i]);
+					Ssum += Ndata[i] * logPdata[i];
+					for(int k=0; k<3; k++) Pdata[k][i] += pRot[k] * Ndata[i];
+				}
+			}
+			else
+			{	for(int i=0; i<gInfo.nr; i++)
+				{	Ndata[i] = prefac * exp(logPdata[i]);
+					Ssum += Ndata[i] * logPdata[i];
+				}
+			}
+			St[iThread] += gInfo.dV * Ssum;
+			#endif
+			//Accumulate N_o to each site density with appropriate translations (in a single pass over N_o):
+			terms.clear();
+			for(unsigned i=0; i<nSites; i++)
+				for(vector3<> pos: molecule.sites[i]->positions)
+					terms.push_back(TaxpyTerm(rot*pos, 1., 0, i));
+			trans.taxpyBatch(terms, &N_o, Nt[iThread].data());
+		}
+	};
+	threadLaunch(nThreads, &processOrientations, 0);
+	//Collect over threads:
+	sumThreads(Nt, N, nSites);
 	double& S = ((IdealGasPomega*)this)->S;
-	S=0.0;
+	S = 0.; for(double St_t: St) S += St_t;
 	VectorField P;
-	//Loop over orientations:
-	for(int o=oStart; o<oStop; o++)
-	{	matrix3<> rot = matrixFromEuler(quad.euler(o));
-		ScalarField logPomega_o; getDensities_o(o, rot, indep,logPomega_o);
-		ScalarField N_o = (quad.weight(o) * Nbulk) * exp(logPomega_o); //contribution form this orientation
-		//Accumulate N_o to each site density with appropriate translations:
-		for(unsigned i=0; i<molecule.sites.size(); i++)
-			for(vector3<> pos: molecule.sites[i]->positions)
-				trans.taxpy(rot*pos, 1., N_o, N[i]);
-		//Accumulate contributions to the entropy:
-		S += gInfo.dV*dot(N_o, logPomega_o);
-		//Accumulate the polarization density:
-		if(pMol.length_squared()) P += (rot * pMol) * N_o;
-	}
+	if(hasDipole) for(VectorField& P_t: Pt) P += P_t;
 	//MPI collect:
-	for(unsigned i=0; i<molecule.sites.size(); i++) { nullToZero(N[i],gInfo); N[i]->allReduce(MPIUtil::ReduceSum); }
+	for(unsigned i=0; i<nSites; i++) { nullToZero(N[i],gInfo); N[i]->allReduce(MPIUtil::ReduceSum); }
 	mpiUtil->allReduce(S, MPIUtil::ReduceSum);
-	if(pMol.length_squared()) for(int k=0; k<3; k++) { nullToZero(P[k],gInfo); P[k]->allReduce(MPIUtil::ReduceSum); }
+	if(hasDipole) for(int k=0; k<3; k++) { nullToZero(P[k],gInfo); P[k]->allReduce(MPIUtil::ReduceSum); }
+	//Reconstruct contributions of symmetry-equivalent orientations:
+	for(unsigned i=0; i<nSites; i++) symmetrize(N[i]);
+	if(hasDipole) symmetrizeVector(P.component.data());
 	//Compute and cache dipole correlation correction:
 	IdealGasPomega* cache = ((IdealGasPomega*)this);
-	if(pMol.length_squared())
+	if(hasDipole)
 	{	P0 = sumComponents(P) / gInfo.nr;
 		cache->Ecorr_P = I(molecule.mfKernel*(molecule.mfKernel*(corrPrefac*J(P))));
 		cache->Ecorr = 0.5*gInfo.dV*dot(cache->Ecorr_P, P);
@@ -112,6 +326,7 @@ void IdealGasPomega::getDensities(const ScalarField* indep, ScalarField* N, vect
 		cache->Ecorr = 0;
 		cache->Ecorr_P = 0;
 	}
+	watch.stop();
 }
 
 double IdealGasPomega::compute(const ScalarField* indep, const ScalarField* N, ScalarField* Phi_N, const double Nscale, double& Phi_Nscale) const
@@ -133,24 +348,69 @@ double IdealGasPomega::compute(const ScalarField* indep, const ScalarField* N, S
 }
 
 void IdealGasPomega::convertGradients(const ScalarField* indep, const ScalarField* N, const ScalarField* Phi_N, const vector3<>& Phi_P0, ScalarField* Phi_indep, const double Nscale) const
-{	for(int k=0; k<nIndep; k++) Phi_indep[k]=0;
-	//Loop over orientations:
-	for(int o=oStart; o<oStop; o++)
-	{	matrix3<> rot = matrixFromEuler(quad.euler(o));
-		ScalarField logPomega_o; getDensities_o(o, rot, indep, logPomega_o);
-		ScalarField N_o = (quad.weight(o) * Nbulk * Nscale) * exp(logPomega_o);
-		ScalarField Phi_N_o; //gradient w.r.t N_o (as calculated in getDensities)
-		//Collect the contributions from each Phi_N in Phi_N_o
-		for(unsigned i=0; i<molecule.sites.size(); i++)
-			for(vector3<> pos: molecule.sites[i]->positions)
-				trans.taxpy(-rot*pos, 1., Phi_N[i], Phi_N_o);
-		//Collect the contributions from the entropy:
-		Phi_N_o += T*logPomega_o;
-		//Collect the contribution from Phi_P0 and Ecorr_P:
-		if(pMol.length_squared()) Phi_N_o += dot(rot * pMol, Nscale*Ecorr_P) + dot(rot * pMol, Phi_P0);
-		//Propagate Phi_N_o to Phi_logPomega_o and then to Phi_indep:
-		convertGradients_o(o, rot, N_o*Phi_N_o, Phi_indep);
+{	static StopWatch watch("IdealGasPomega::convertGradients"); watch.start();
+	unsigned nSites = molecule.sites.size();
+	bool hasDipole = pMol.length_squared();
+	//Gradient accumulators: when there are fewer independent fields than orientations (compressed representations),
+	//every orientation contributes to all of them, otherwise each is touched by one orientation (and hence one thread):
+	int nAccumPerThread = (nIndep < int(oMine.size())) ? nIndep : 0;
+	int nThreads = orientationThreads(oMine.size(), nAccumPerThread + 2, nIndep, gInfo); //accumulators and work buffers
+	std::vector<ScalarFieldArray> Phi_indep_t(nThreads, ScalarFieldArray(nIndep)); //per-thread gradients (only touched entries allocated)
+	//Symmetrize Phi_N (adjoint of the symmetrization in getDensities), when orientations are reduced by symmetry:
+	ScalarFieldArray Phi_Nsym;
+	if(symMesh.size())
+	{	Phi_Nsym.assign(Phi_N, Phi_N+nSites);
+		for(ScalarField& Phi_Ni: Phi_Nsym) symmetrize(Phi_Ni);
+		Phi_N = Phi_Nsym.data();
 	}
+	std::atomic<int> jNext(0);
+	auto processOrientations = [&](int iThread, int nThreads)
+	{	ScalarField logPomega_o, Phi_N_o;
+		std::vector<TaxpyTerm> terms;
+		for(int j=jNext++; j<int(oMine.size()); j=jNext++)
+		{	int o = oMine[j];
+			matrix3<> rot = matrixFromEuler(quad.euler(o));
+			if(logPomega_o) logPomega_o->zero();
+			getDensities_o(o, rot, indep, logPomega_o);
+			double prefac = weight(o) * Nbulk * Nscale;
+			vector3<> pRot = rot * pMol;
+			//Collect the contributions from each Phi_N in Phi_N_o (gradient w.r.t N_o as calculated in getDensities):
+			if(Phi_N_o) Phi_N_o->zero();
+			terms.clear();
+			for(unsigned i=0; i<nSites; i++)
+				for(vector3<> pos: molecule.sites[i]->positions)
+					terms.push_back(TaxpyTerm(-rot*pos, 1., i, 0));
+			trans.taxpyBatch(terms, Phi_N, &Phi_N_o);
+			//Add entropy and dipole contributions, and propagate to Phi_logPomega_o = N_o * Phi_N_o (fused in a single pass):
+			#ifdef GPU_ENABLED
+			Phi_N_o += T*logPomega_o;
+			if(hasDipole) Phi_N_o += dot(pRot, Nscale*Ecorr_P) + dot(pRot, Phi_P0);
+			Phi_N_o = (prefac * exp(logPomega_o)) * Phi_N_o;
+			#else
+			const double* logPdata = logPomega_o->data();
+			double* PhiData = Phi_N_o->data();
+			if(hasDipole)
+			{	const double* EcorrData[3]; for(int k=0; k<3; k++) EcorrData[k] = Ecorr_P[k]->data();
+				double PhiP0dot = dot(pRot, Phi_P0);
+				vector3<> pRotScaled = Nscale * pRot;
+				for(int i=0; i<gInfo.nr; i++)
+				{	double PhiDipole = PhiP0dot;
+					for(int k=0; k<3; k++) PhiDipole += pRotScaled[k] * EcorrData[k][i];
+					PhiData[i] = prefac * exp(logPdata[i]) * (PhiData[i] + T*logPdata[i] + PhiDipole);
+				}
+			}
+			else
+			{	for(int i=0; i<gInfo.nr; i++)
+					PhiData[i] = prefac * exp(logPdata[i]) * (PhiData[i] + T*logPdata[i]);
+			}
+			#endif
+			//Propagate Phi_logPomega_o to Phi_indep:
+			convertGradients_o(o, rot, Phi_N_o, Phi_indep_t[iThread].data());
+		}
+	};
+	threadLaunch(nThreads, &processOrientations, 0);
+	sumThreads(Phi_indep_t, Phi_indep, nIndep);
 	for(int k=0; k<nIndep; k++) { nullToZero(Phi_indep[k],gInfo); Phi_indep[k]->allReduce(MPIUtil::ReduceSum); }
+	symmetrizeState(Phi_indep);
+	watch.stop();
 }
-
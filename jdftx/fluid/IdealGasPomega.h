@@ -46,16 +46,32 @@ protected:
 	const SO3quad& quad; //!< quadrature for orientation integral
 	const TranslationOperator& trans; //!< translation operator for orientation integral
 	vector3<> pMol; //!< molecule dipole moment in reference frame
-	int oStart, oStop; //!< portion of orientation loop handled by current process
+	std::vector<int> oMine; //!< symmetry-inequivalent orientations handled by current process
+	std::vector<double> oMult; //!< number of orientations represented by each orientation (0 for those reconstructed by symmetry)
+	double weight(int o) const { return quad.weight(o) * oMult[o]; } //!< quadrature weight of orientation o including its symmetric images
 	
 	virtual string representationName() const;
 	
+	void symmetrize(ScalarField& x) const; //!< symmetrize a scalar field under the symmetries used for orientation reduction
+	void symmetrizeVector(ScalarField* x) const; //!< symmetrize a vector field (3 Cartesian components) under the symmetries used for orientation reduction
+	
+	//! Symmetrize the state (or gradients w.r.t it), so that the state remains in the symmetric subspace in which the
+	//! orientation reduction is exact. The default does nothing, as the per-orientation states of the
+	//! inequivalent orientations fully specify Pomega; derived classes with shared states must override.
+	virtual void symmetrizeState(ScalarField* state) const;
+	
 	//These functions are called once for each orientation:
 	virtual void initState_o(int o, const matrix3<>& rot, double scale, const ScalarField& Eo, ScalarField* state) const;
 	virtual void getDensities_o(int o, const matrix3<>& rot, const ScalarField* state, ScalarField& logPomega_o) const;
 	virtual void convertGradients_o(int o, const matrix3<>& rot, const ScalarField& Phi_logPomega_o, ScalarField* Phi_state) const;
 	
 private:
+	//Symmetries of the external potentials used to reduce orientation sampling:
+	std::vector< matrix3<int> > symMesh; //!< rotations in mesh coordinates
+	std::vector< vector3<int> > symOffset; //!< translations in mesh coordinates
+	std::vector< matrix3<> > symCart; //!< rotations in Cartesian coordinates
+	void setupSymmetries(const std::vector<SpaceGroupOp>& sym); //!< select symmetries compatible with the grid and quadrature, and set oMult
+	
 	double S; //!< cache the entropy, because it is most efficiently computed during getDensities()
 	double Ecorr; VectorField Ecorr_P; //!< cache the correlation correction and its derivatives, since they are most efficiently computed during getDensities()
 };
@@ -47,13 +47,22 @@ void IdealGasPsiAlpha::initState(const ScalarField* Vex, ScalarField* psi, doubl
 }
 
 void IdealGasPsiAlpha::getDensities_o(int o, const matrix3<>& rot, const ScalarField* psi, ScalarField& logPomega_o) const
-{	for(unsigned i=0; i<molecule.sites.size(); i++)
+{	std::vector<TaxpyTerm> terms;
+	for(unsigned i=0; i<molecule.sites.size(); i++)
 		for(vector3<> pos: molecule.sites[i]->positions)
-			trans.taxpy(-rot*pos, 1., psi[i], logPomega_o);
+			terms.push_back(TaxpyTerm(-rot*pos, 1., i, 0));
+	trans.taxpyBatch(terms, psi, &logPomega_o);
 }
 
 void IdealGasPsiAlpha::convertGradients_o(int o, const matrix3<>& rot, const ScalarField& Phi_logPomega_o, ScalarField* Phi_psi) const
-{	for(unsigned i=0; i<molecule.sites.size(); i++)
+{	std::vector<TaxpyTerm> terms;
+	for(unsigned i=0; i<molecule.sites.size(); i++)
 		for(vector3<> pos: molecule.sites[i]->positions)
-			trans.taxpy(rot*pos, 1., Phi_logPomega_o, Phi_psi[i]);
+			terms.push_back(TaxpyTerm(rot*pos, 1., 0, i));
+	trans.taxpyBatch(terms, &Phi_logPomega_o, Phi_psi);
+}
+
+void IdealGasPsiAlpha::symmetrizeState(ScalarField* psi) const
+{	for(unsigned i=0; i<molecule.sites.size(); i++)
+		symmetrize(psi[i]);
 }
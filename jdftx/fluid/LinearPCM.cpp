@@ -47,7 +47,8 @@ ScalarFieldTilde LinearPCM::hessian(const ScalarFieldTilde& phiTilde) const
 }
 
 ScalarFieldTilde LinearPCM::precondition(const ScalarFieldTilde& rTilde) const
-{	return Kkernel*(J(epsInv*I(Kkernel*rTilde)));
+{	if(fsp.cavityPreconditioner) return preconditionCavity(rTilde);
+	return Kkernel*(J(epsInv*I(Kkernel*rTilde)));
 }
 
 //Initialize Kkernel to square-root of the inverse kinetic operator
@@ -77,6 +78,15 @@ void LinearPCM::updatePreconditioner(const ScalarField& epsilon, const ScalarFie
 	double epsMean = sum(epsilon) / gInfo.nr;
 	double kappaSqMean = (kappaSq ? sum(kappaSq) : 0.) / gInfo.nr;
 	Kkernel.init(0, 0.02, gInfo.GmaxGrid, setPreconditionerKernel, epsMean, sqrt(kappaSqMean/epsMean));
+	if(fsp.cavityPreconditioner)
+	{	//Response of the fluid phase (averaged over the cavity, to account for overrides):
+		double shapeSum = sum(shape);
+		double epsFluid = shapeSum ? 1. + (sum(epsilon) - gInfo.nr)/shapeSum : epsBulk;
+		double kappaSqFluid = (shapeSum && kappaSq) ? sum(kappaSq)/shapeSum : 0.;
+		if(KfluidCavity) KfluidCavity.free();
+		KfluidCavity.init(0, 0.02, gInfo.GmaxGrid, inverseResponseKernel, epsFluid, kappaSqFluid);
+		updateCavityPreconditioner();
+	}
 }
 
 void LinearPCM::override(const ScalarField& epsilon, const ScalarField& kappaSq)
@@ -130,3 +140,11 @@ void LinearPCM::loadState(const char* filename)
 void LinearPCM::saveState(const char* filename) const
 {	if(mpiUtil->isHead()) saveRawBinary(I(state), filename); //saved data is in real space
 }
+
+ScalarFieldArray LinearPCM::getStateArray() const
+{	return state ? ScalarFieldArray(1, I(state)) : ScalarFieldArray();
+}
+
+void LinearPCM::setStateArray(const ScalarFieldArray& x)
+{	state = J(x[0]);
+}
@@ -283,6 +283,19 @@ void NonlinearPCM::saveState(const char* filename) const
 {	if(mpiUtil->isHead()) state.saveToFile(filename);
 }
 
+ScalarFieldArray NonlinearPCM::getStateArray() const
+{	if(fsp.nonlinearSCF)
+		return (linearPCM && linearPCM->state) ? ScalarFieldArray(1, I(linearPCM->state)) : ScalarFieldArray();
+	return state ? clone(state.component) : ScalarFieldArray();
+}
+
+void NonlinearPCM::setStateArray(const ScalarFieldArray& x)
+{	if(fsp.nonlinearSCF)
+		linearPCM->state = J(x[0]);
+	else
+		state.component = clone(x);
+}
+
 double NonlinearPCM::get_Adiel_and_grad_internal(ScalarFieldTilde& Adiel_rhoExplicitTilde, ScalarFieldTilde& Adiel_nCavityTilde, IonicGradient* extraForces, bool electricOnly) const
 {	ScalarFieldMuEps Adiel_state;
 	double A = (*this)(state, Adiel_state, &Adiel_rhoExplicitTilde, &Adiel_nCavityTilde, electricOnly);
@@ -302,10 +315,22 @@ double NonlinearPCM::compute(ScalarFieldMuEps* grad, ScalarFieldMuEps* Kgrad)
 	{	const ScalarFieldMuEps& in = grad ? *grad : gradUnused;
 		double dielPrefac = 1./(gInfo.dV * dielectricEval->NT);
 		double ionsPrefac = screeningEval ? 1./(gInfo.dV * screeningEval->NT) : 0.;
-		setMuEps(*Kgrad,
-			ionsPrefac * I(preconditioner*J(getMuPlus(in))),
-			ionsPrefac * I(preconditioner*J(getMuMinus(in))),
-			dielPrefac * getEps(in));
+		if(fsp.cavityPreconditioner)
+		{	//Additionally scale out the local part of the Hessian, which is proportional to the cavity shape
+			//(symmetrically around the Fourier kernel in the mu channel, so as to remain positive-definite):
+			const double shapeFloor = 1e-3; //bounds the step in regions with negligible fluid
+			ScalarField invShape = inv(shape + shapeFloor);
+			ScalarField invSqrtShape = sqrt(invShape);
+			setMuEps(*Kgrad,
+				ionsPrefac * invSqrtShape * I(preconditioner*J(invSqrtShape * getMuPlus(in))),
+				ionsPrefac * invSqrtShape * I(preconditioner*J(invSqrtShape * getMuMinus(in))),
+				dielPrefac * invShape * getEps(in));
+		}
+		else
+			setMuEps(*Kgrad,
+				ionsPrefac * I(preconditioner*J(getMuPlus(in))),
+				ionsPrefac * I(preconditioner*J(getMuMinus(in))),
+				dielPrefac * getEps(in));
 	}
 	return E;
 }
@@ -48,6 +48,8 @@ public:
 
 	void loadState(const char* filename); //!< Load state from file
 	void saveState(const char* filename) const; //!< Save state to file
+	ScalarFieldArray getStateArray() const; //!< Get state for extrapolation (potential in SCF mode, and mu/eps otherwise)
+	void setStateArray(const ScalarFieldArray&); //!< Set state from extrapolation
 	void dumpDensities(const char* filenamePattern) const;
 	void minimizeFluid(); //!< Converge using nonlinear conjugate gradients
 
@@ -139,12 +139,35 @@ PCM::PCM(const Everything& e, const FluidSolverParams& fsp): FluidSolver(e,fsp)
 			break;
 		}
 	}
+	
+	if(fsp.cavityPreconditioner)
+		KvacuumCavity.init(0, dG, e.gInfo.GmaxGrid, inverseResponseKernel, 1., 0.);
 }
 
 PCM::~PCM()
 {	for(int i=0; i<2; i++) wExpand[i].free();
 	wCavity.free();
 	for(unsigned i=0; i<Sf.size(); i++) Sf[i].free();
+	if(KfluidCavity) KfluidCavity.free();
+	if(KvacuumCavity) KvacuumCavity.free();
+}
+
+//The response of the fluid and vacuum regions differ by orders of magnitude for high-dielectric,
+//high-ionic-strength electrolytes, which is poorly captured by a single bulk-averaged kernel.
+//Instead, apply the inverse homogeneous response of each phase within its region: K = sum_p W_p^(1/2) K_p W_p^(1/2),
+//where the phase weights W_p are shape and 1-shape. This remains symmetric positive-definite, as required by CG.
+void PCM::updateCavityPreconditioner()
+{	ScalarField s = clone(shape);
+	double sMin, sMax;
+	callPref(eblas_capMinMax)(gInfo.nr, s->dataPref(), sMin, sMax, 0., 1.);
+	sqrtShapeVacuum = sqrt(1. - s);
+	sqrtShapeFluid = sqrt(s);
+}
+
+ScalarFieldTilde PCM::preconditionCavity(const ScalarFieldTilde& rTilde) const
+{	ScalarField r = I(rTilde);
+	return J(sqrtShapeFluid * I(KfluidCavity * J(sqrtShapeFluid * r)))
+		+ J(sqrtShapeVacuum * I(KvacuumCavity * J(sqrtShapeVacuum * r)));
 }
 
 void PCM::updateCavity()
@@ -50,6 +50,14 @@ protected:
 	void propagateCavityGradients(const ScalarField& A_shape, ScalarField& A_nCavity, ScalarFieldTilde& A_rhoExplicitTilde, bool electricOnly) const; //!< propagate A_shape (+ cached Acavity_shape) and accumulate to those w.r.t nCavity and rhoExplicitTilde
 	void setExtraForces(IonicGradient* forces, const ScalarFieldTilde& A_nCavityTilde) const; //!< set extra fluid forces (vdw and full-core forces, when applicable)
 	ScalarFieldTilde getFullCore() const; //!< get full core correction for PCM variants that need them
+	
+	//Cavity-aware preconditioner (see FluidSolverParams::cavityPreconditioner):
+	RadialFunctionG KfluidCavity; //!< inverse response of the homogeneous bulk fluid (initialized by derived classes)
+	RadialFunctionG KvacuumCavity; //!< inverse response of vacuum (inverse Laplacian)
+	ScalarField sqrtShapeFluid, sqrtShapeVacuum; //!< square roots of the phase weights (shape and 1-shape)
+	void updateCavityPreconditioner(); //!< update phase weights from the current shape (call after updateCavity)
+	ScalarFieldTilde preconditionCavity(const ScalarFieldTilde&) const; //!< approximate inverse response, blended between phases by cavity shape
+	static double inverseResponseKernel(double G, double epsilon, double kappaSq) { double den = epsilon*G*G + kappaSq; return den ? 1./den : 0.; } //!< inverse of homogeneous linear response
 private:
 	ScalarField Acavity_shape, Acavity_shapeVdw; //!< Cached gradients of cavitation (and dispersion) energies w.r.t shape functions
 	double A_nc, A_tension, A_vdwScale, A_eta_wDiel, A_pCavity; //!< Cached derivatives w.r.t fit parameters (accessed via dumpDebug() for PCM fits)
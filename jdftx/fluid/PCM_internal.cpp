@@ -23,15 +23,22 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/VectorField.h>
 #include <core/Units.h>
 #include <core/Util.h>
+#include <core/Simd.h>
 
 
 namespace ShapeFunction
 {
+	void compute_sub(size_t iStart, size_t iStop, const double* n, double* shape, const double nc, const double sigma)
+	{	SIMD_LOOP for(size_t i=iStart; i<iStop; i++) compute_calc(i, n, shape, nc, sigma);
+	}
 	void compute(int N, const double* n, double* shape, const double nc, const double sigma)
-	{	threadedLoop(compute_calc, N, n, shape, nc, sigma);
+	{	threadLaunch(compute_sub, N, n, shape, nc, sigma);
+	}
+	void propagateGradient_sub(size_t iStart, size_t iStop, const double* n, const double* grad_shape, double* grad_n, const double nc, const double sigma)
+	{	SIMD_LOOP for(size_t i=iStart; i<iStop; i++) propagateGradient_calc(i, n, grad_shape, grad_n, nc, sigma);
 	}
 	void propagateGradient(int N, const double* n, const double* grad_shape, double* grad_n, const double nc, const double sigma)
-	{	threadedLoop(propagateGradient_calc, N, n, grad_shape, grad_n, nc, sigma);
+	{	threadLaunch(propagateGradient_sub, N, n, grad_shape, grad_n, nc, sigma);
 	}
 	#ifdef GPU_ENABLED
 	void compute_gpu(int N, const double* n, double* shape, const double nc, const double sigma);
@@ -163,14 +170,14 @@ namespace NonlinearPCMeval
 	}
 	
 	void ScreeningFreeEnergy_sub(size_t iStart, size_t iStop, double mu0, const double* muPlus, const double* muMinus, const double* s, double* rho, double* A, double* A_muPlus, double* A_muMinus, double* A_s, const Screening& eval)
-	{	for(size_t i=iStart; i<iStop; i++) eval.freeEnergy_calc(i, mu0, muPlus, muMinus, s, rho, A, A_muPlus, A_muMinus, A_s);
+	{	SIMD_LOOP for(size_t i=iStart; i<iStop; i++) eval.freeEnergy_calc(i, mu0, muPlus, muMinus, s, rho, A, A_muPlus, A_muMinus, A_s);
 	}
 	void Screening::freeEnergy(size_t N, double mu0, const double* muPlus, const double* muMinus, const double* s, double* rho, double* A, double* A_muPlus, double* A_muMinus, double* A_s) const
 	{	threadLaunch(ScreeningFreeEnergy_sub, N, mu0, muPlus, muMinus, s, rho, A, A_muPlus, A_muMinus, A_s, *this);
 	}
 	
 	void ScreeningConvertDerivative_sub(size_t iStart, size_t iStop, double mu0, const double* muPlus, const double* muMinus, const double* s, const double* A_rho, double* A_muPlus, double* A_muMinus, double* A_s, const Screening& eval)
-	{	for(size_t i=iStart; i<iStop; i++) eval.convertDerivative_calc(i, mu0, muPlus, muMinus, s, A_rho, A_muPlus, A_muMinus, A_s);
+	{	SIMD_LOOP for(size_t i=iStart; i<iStop; i++) eval.convertDerivative_calc(i, mu0, muPlus, muMinus, s, A_rho, A_muPlus, A_muMinus, A_s);
 	}
 	void Screening::convertDerivative(size_t N, double mu0, const double* muPlus, const double* muMinus, const double* s, const double* A_rho, double* A_muPlus, double* A_muMinus, double* A_s) const
 	{	threadLaunch(ScreeningConvertDerivative_sub, N, mu0, muPlus, muMinus, s, A_rho, A_muPlus, A_muMinus, A_s, *this);
@@ -198,7 +205,7 @@ namespace NonlinearPCMeval
 	}
 	
 	void DielectricFreeEnergy_sub(size_t iStart, size_t iStop, vector3<const double*> eps, const double* s, vector3<double*> p, double* A, vector3<double*> A_eps, double* A_s, const Dielectric& eval)
-	{	for(size_t i=iStart; i<iStop; i++) eval.freeEnergy_calc(i, eps, s, p, A, A_eps, A_s);
+	{	SIMD_LOOP for(size_t i=iStart; i<iStop; i++) eval.freeEnergy_calc(i, eps, s, p, A, A_eps, A_s);
 	}
 	void Dielectric::freeEnergy(size_t N,
 		vector3<const double*> eps, const double* s, vector3<double*> p, double* A, vector3<double*> A_eps, double* A_s) const
@@ -206,7 +213,7 @@ namespace NonlinearPCMeval
 	}
 	
 	void DielectricConvertDerivative_sub(size_t iStart, size_t iStop, vector3<const double*> eps, const double* s, vector3<const double*> A_p, vector3<double*> A_eps, double* A_s, const Dielectric& eval)
-	{	for(size_t i=iStart; i<iStop; i++) eval.convertDerivative_calc(i, eps, s, A_p, A_eps, A_s);
+	{	SIMD_LOOP for(size_t i=iStart; i<iStop; i++) eval.convertDerivative_calc(i, eps, s, A_p, A_eps, A_s);
 	}
 	void Dielectric::convertDerivative(size_t N, vector3<const double*> eps, const double* s, vector3<const double*> A_p, vector3<double*> A_eps, double* A_s) const
 	{	threadLaunch(DielectricConvertDerivative_sub, N, eps, s, A_p, A_eps, A_s, *this);
@@ -33,6 +33,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Operators.h>
 #include <core/EnergyComponents.h>
 #include <fluid/FluidSolverParams.h>
+#include <core/Simd.h>
 
 //! Original shape function from \cite JDFT, \cite PCM-Kendra and \cite NonlinearPCM
 namespace ShapeFunction
@@ -81,10 +82,10 @@ namespace ShapeFunctionSCCS
 
 namespace ShapeFunction
 {
-	__hostanddev__ void compute_calc(int i, const double* nCavity, double* shape, const double nc, const double sigma)
+	__hostanddev__ void compute_calc(size_t i, const double* nCavity, double* shape, const double nc, const double sigma)
 	{	shape[i] = erfc(sqrt(0.5)*log(fabs(nCavity[i])/nc)/sigma)*0.5;
 	}
-	__hostanddev__ void propagateGradient_calc(int i, const double* nCavity, const double* grad_shape, double* grad_nCavity, const double nc, const double sigma)
+	__hostanddev__ void propagateGradient_calc(size_t i, const double* nCavity, const double* grad_shape, double* grad_nCavity, const double nc, const double sigma)
 	{	grad_nCavity[i] += (-1.0/(nc*sigma*sqrt(2*M_PI))) * grad_shape[i]
 			* exp(0.5*(pow(sigma,2) - pow(log(fabs(nCavity[i])/nc)/sigma + sigma, 2)));
 	}
@@ -240,12 +241,21 @@ namespace NonlinearPCMeval
 		
 		//! Hard sphere free energy per particle and derivative, where x is total packing fraction
 		__hostanddev__ double fHS(double xIn, double& f_xIn) const
-		{	double x = xIn, x_xIn = 1.;
+		{
+			#ifdef SIMD_BRANCHFREE
+			//Soft packing: remap [0.5,infty) on to [0.5,1) (selected without branches to allow vectorization)
+			bool soft = (xIn > 0.5);
+			double xInInv = 1./xIn;
+			double x = soft ? 1.-0.25*xInInv : xIn;
+			double x_xIn = soft ? 0.25*xInInv*xInInv : 1.;
+			#else
+			double x = xIn, x_xIn = 1.;
 			if(xIn > 0.5) //soft packing: remap [0.5,infty) on to [0.5,1)
 			{	double xInInv = 1./xIn;
 				x = 1.-0.25*xInInv;
 				x_xIn = 0.25*xInInv*xInInv;
 			}
+			#endif
 			double den = 1./(1-x), den0 = 1./(1-x0);
 			double comb = (x-x0)*den*den0, comb_x = den*den;
 			double prefac = (2./x0);
@@ -375,7 +385,23 @@ namespace NonlinearPCMeval
 				logsinch = epsSq*(1.0/6);
 			}
 			else
-			{	if(eps < 1e-1) //Use series expansions
+			{
+				#ifdef SIMD_BRANCHFREE
+				//Both the series expansions (used for small eps) and the closed forms are evaluated
+				//and the results selected without branches, so that the CPU loops vectorize:
+				bool series = (eps < 1e-1);
+				double fracSeries = 1.0/3 + epsSq*(-1.0/45 + epsSq*(2.0/945 + epsSq*(-1.0/4725)));
+				double frac_epsSqHlfSeries = -2.0/45 + epsSq*(8.0/945 + epsSq*(-6.0/4725));
+				double logsinchSeries = epsSq*(1.0/6 + epsSq*(-1.0/180 + epsSq*(1.0/2835)));
+				double epsCothEps = eps/tanh(eps), sinhEps = sinh(eps);
+				double epsCschEps = eps/sinhEps;
+				frac = series ? fracSeries : (epsCothEps-1)/epsSq;
+				frac_epsSqHlf = series ? frac_epsSqHlfSeries : (2 - epsCothEps - epsCschEps*epsCschEps)/(epsSq*epsSq);
+				double logsinchLarge = eps - log(2.*eps);
+				double logsinchSmall = log(sinhEps/eps);
+				logsinch = series ? logsinchSeries : (eps<20. ? logsinchSmall : logsinchLarge);
+				#else
+				if(eps < 1e-1) //Use series expansions
 				{	frac = 1.0/3 + epsSq*(-1.0/45 + epsSq*(2.0/945 + epsSq*(-1.0/4725)));
 					frac_epsSqHlf = -2.0/45 + epsSq*(8.0/945 + epsSq*(-6.0/4725));
 					logsinch = epsSq*(1.0/6 + epsSq*(-1.0/180 + epsSq*(1.0/2835)));
@@ -385,6 +411,7 @@ namespace NonlinearPCMeval
 					frac_epsSqHlf = (2 - eps/tanh(eps) - pow(eps/sinh(eps),2))/(epsSq*epsSq);
 					logsinch = eps<20. ? log(sinh(eps)/eps) : eps - log(2.*eps);
 				}
+				#endif
 			}
 		}
 		
@@ -154,7 +154,7 @@ SaLSA::SaLSA(const Everything& e, const FluidSolverParams& fsp)
 	assert(fabs(k2factor-this->k2factor) < 1e-3); //verify consistency of site charges
 	
 	//Initialize preconditioner kernel:
-	std::vector<double> KkernelSamples(nGradial);
+	std::vector<double> KkernelSamples(nGradial), KfluidSamples(nGradial);
 	for(unsigned i=0; i<nGradial; i++)
 	{	double G = i*dG, G2=G*G;
 		//Compute diagonal part of the hessian ( 4pi(Vc^-1 + chi) ):
@@ -163,8 +163,10 @@ SaLSA::SaLSA(const Everything& e, const FluidSolverParams& fsp)
 			diagH += pow(G2,resp->l) * pow(resp->V(G), 2);
 		//Set its inverse square-root as the preconditioner:
 		KkernelSamples[i] = (diagH>GzeroTol) ? 1./sqrt(diagH) : 0.;
+		KfluidSamples[i] = (diagH>GzeroTol) ? 1./diagH : 0.; //bulk fluid inverse response for the cavity-aware preconditioner
 	}
 	Kkernel.init(0, KkernelSamples, dG);
+	if(fsp.cavityPreconditioner) KfluidCavity.init(0, KfluidSamples, dG);
 	
 	//MPI division:
 	TaskDivision(response.size(), mpiUtil).myRange(rStart, rStop);
@@ -195,7 +197,8 @@ ScalarFieldTilde SaLSA::hessian(const ScalarFieldTilde& phiTilde) const
 }
 
 ScalarFieldTilde SaLSA::precondition(const ScalarFieldTilde& rTilde) const
-{	return Kkernel*(J(epsInv*I(Kkernel*rTilde)));
+{	if(fsp.cavityPreconditioner) return preconditionCavity(rTilde);
+	return Kkernel*(J(epsInv*I(Kkernel*rTilde)));
 }
 
 double SaLSA::sync(double x) const
@@ -218,6 +221,7 @@ void SaLSA::set_internal(const ScalarFieldTilde& rhoExplicitTilde, const ScalarF
 	
 	//Update the inhomogeneity factor of the preconditioner
 	epsInv = inv(1. + (epsBulk-1.)*shape);
+	if(fsp.cavityPreconditioner) updateCavityPreconditioner();
 	
 	//Initialize the state if it hasn't been loaded:
 	if(!state) nullToZero(state, gInfo);
@@ -282,6 +286,14 @@ void SaLSA::saveState(const char* filename) const
 {	if(mpiUtil->isHead()) saveRawBinary(I(state), filename); //saved data is in real space
 }
 
+ScalarFieldArray SaLSA::getStateArray() const
+{	return state ? ScalarFieldArray(1, I(state)) : ScalarFieldArray();
+}
+
+void SaLSA::setStateArray(const ScalarFieldArray& x)
+{	state = J(x[0]);
+}
+
 void SaLSA::dumpDensities(const char* filenamePattern) const
 {	PCM::dumpDensities(filenamePattern);
 	
@@ -42,6 +42,8 @@ public:
 	void minimizeFluid(); //!< Converge using linear conjugate gradients
 	void loadState(const char* filename); //!< Load state from file
 	void saveState(const char* filename) const; //!< Save state to file
+	ScalarFieldArray getStateArray() const; //!< Get state (potential) for extrapolation
+	void setStateArray(const ScalarFieldArray&); //!< Set state (potential) from extrapolation
 	void dumpDensities(const char* filenamePattern) const; //!< dump cavity shape functions
 
 protected:
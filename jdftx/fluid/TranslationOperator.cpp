@@ -20,17 +20,74 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <fluid/TranslationOperator.h>
 #include <fluid/TranslationOperator_internal.h>
 #include <core/Operators.h>
+#include <algorithm>
 
 
 TranslationOperator::TranslationOperator(const GridInfo& gInfo) : gInfo(gInfo)
 {
 }
 
+void TranslationOperator::taxpyBatch(const std::vector<TaxpyTerm>& terms, const ScalarField* x, ScalarField* y) const
+{	for(const TaxpyTerm& term: terms)
+		taxpy(term.t, term.alpha, x[term.iX], y[term.iY]);
+}
+
 TranslationOperatorSpline::TranslationOperatorSpline(const GridInfo& gInfo, SplineType splineType)
 : TranslationOperator(gInfo), splineType(splineType)
 {
 }
 
+TranslationOperatorSpline::Stencil TranslationOperatorSpline::getStencil(const vector3<>& t) const
+{	std::lock_guard<std::mutex> lock(stencilLock);
+	if(!(Rcache == gInfo.R)) //lattice changed (or first use): invalidate cache
+	{	stencilCache.clear();
+		Rcache = gInfo.R;
+	}
+	auto iter = stencilCache.find(t);
+	if(iter != stencilCache.end()) return iter->second;
+	//Compute stencil:
+	//Perform a gather with the inverse translation (hence negate t),
+	//instead of scatter which is less efficient to parallelize
+	Stencil stencil;
+	vector3<>& Tfrac = stencil.Tfrac;
+	vector3<int>& Tint = stencil.Tint;
+	Tfrac = Diag(gInfo.S) * inv(gInfo.R) * (-t); //now in grid point units
+	switch(splineType)
+	{	case Constant:
+		{	for(int k=0; k<3; k++)
+			{	//round to nearest integer (and ensure symmetric rounding direction for transpose correctness):
+				Tint[k] = int(copysign(floor(fabs(Tfrac[k])+0.5), Tfrac[k]));
+				//reduce to positive first unit cell:
+				Tint[k] = Tint[k] % gInfo.S[k];
+				if(Tint[k]<0) Tint[k] += gInfo.S[k];
+			}
+			Tfrac = vector3<>();
+			std::fill(stencil.w, stencil.w+8, 0.);
+			stencil.w[0] = 1.;
+			break;
+		}
+		case Linear:
+		{	for(int k=0; k<3; k++)
+			{	//reduce to positive first unit cell:
+				Tfrac[k] = fmod(Tfrac[k], gInfo.S[k]);
+				if(Tfrac[k]<0) Tfrac[k] += gInfo.S[k];
+				//separate integral and fractional parts:
+				Tint[k] = int(floor(Tfrac[k]));
+				Tfrac[k] -= Tint[k];
+				Tint[k] = Tint[k] % gInfo.S[k];
+			}
+			for(int i0=0; i0<2; i0++)
+			for(int i1=0; i1<2; i1++)
+			for(int i2=0; i2<2; i2++)
+				stencil.w[4*i0+2*i1+i2] = (i0 ? Tfrac[0] : 1-Tfrac[0]) * (i1 ? Tfrac[1] : 1-Tfrac[1]) * (i2 ? Tfrac[2] : 1-Tfrac[2]);
+			break;
+		}
+	}
+	if(stencilCache.size() >= maxStencils) stencilCache.clear(); //bound memory usage (see maxStencils)
+	stencilCache[t] = stencil;
+	return stencil;
+}
+
 void constantSplineTaxpy_sub(size_t iStart, size_t iStop, const vector3<int> S,
 	double alpha, const double* x, double* y, const vector3<int> Tint)
 {	THREAD_rLoop(constantSplineTaxpy_calc(i, iv, S, alpha, x, y, Tint);)
@@ -46,48 +103,71 @@ void linearSplineTaxpy_gpu(const vector3<int> S,
 	double alpha, const double* x, double* y, const vector3<int> Tint, const vector3<> Tfrac);
 #endif
 void TranslationOperatorSpline::taxpy(const vector3<>& t, double alpha, const ScalarField& x, ScalarField& y) const
-{	//Perform a gather with the inverse translation (hence negate t),
-	//instead of scatter which is less efficient to parallelize
-	vector3<> Tfrac = Diag(gInfo.S) * inv(gInfo.R) * (-t); //now in grid point units
-	vector3<int> Tint;
+{	Stencil stencil = getStencil(t);
 	//Prepare output:
 	nullToZero(y, gInfo);
+	//Launch threads/gpu kernels:
 	switch(splineType)
 	{	case Constant:
-		{	for(int k=0; k<3; k++)
-			{	//round to nearest integer (and ensure symmetric rounding direction for transpose correctness):
-				Tint[k] = int(copysign(floor(fabs(Tfrac[k])+0.5), Tfrac[k]));
-				//reduce to positive first unit cell:
-				Tint[k] = Tint[k] % gInfo.S[k];
-				if(Tint[k]<0) Tint[k] += gInfo.S[k];
-			}
-			//Launch threads/gpu kernels:
 			#ifdef GPU_ENABLED
-			constantSplineTaxpy_gpu(gInfo.S, alpha*x->scale, x->dataGpu(false), y->dataGpu(), Tint);
+			constantSplineTaxpy_gpu(gInfo.S, alpha*x->scale, x->dataGpu(false), y->dataGpu(), stencil.Tint);
 			#else
-			threadLaunch(constantSplineTaxpy_sub, gInfo.nr, gInfo.S, alpha*x->scale, x->data(false), y->data(), Tint);
+			threadLaunch(constantSplineTaxpy_sub, gInfo.nr, gInfo.S, alpha*x->scale, x->data(false), y->data(), stencil.Tint);
 			#endif
 			break;
-		}
 		case Linear:
-		{	for(int k=0; k<3; k++)
-			{	//reduce to positive first unit cell:
-				Tfrac[k] = fmod(Tfrac[k], gInfo.S[k]);
-				if(Tfrac[k]<0) Tfrac[k] += gInfo.S[k];
-				//separate integral and fractional parts:
-				Tint[k] = int(floor(Tfrac[k]));
-				Tfrac[k] -= Tint[k];
-				Tint[k] = Tint[k] % gInfo.S[k];
-			}
-			//Launch threads/gpu kernels:
 			#ifdef GPU_ENABLED
-			linearSplineTaxpy_gpu(gInfo.S, alpha*x->scale, x->dataGpu(false), y->dataGpu(), Tint, Tfrac);
+			linearSplineTaxpy_gpu(gInfo.S, alpha*x->scale, x->dataGpu(false), y->dataGpu(), stencil.Tint, stencil.Tfrac);
 			#else
-			threadLaunch(linearSplineTaxpy_sub, gInfo.nr, gInfo.S, alpha*x->scale, x->data(false), y->data(), Tint, Tfrac);
+			threadLaunch(linearSplineTaxpy_sub, gInfo.nr, gInfo.S, alpha*x->scale, x->data(false), y->data(), stencil.Tint, stencil.Tfrac);
 			#endif
 			break;
+	}
+}
+
+//Batched translation: all terms are applied at each grid point in a single pass, so that the
+//(nearby) source values are read from cache and each output is updated once per point.
+struct SplineTaxpyBatchTerm
+{	const double* x; double* y; double alpha; vector3<int> Tint; const double* w;
+};
+void splineTaxpyBatch_sub(size_t iStart, size_t iStop, const vector3<int> S, bool linear, const std::vector<SplineTaxpyBatchTerm>* terms)
+{	THREAD_rLoop(
+		for(const SplineTaxpyBatchTerm& term: *terms)
+		{	vector3<int> ix = iv + term.Tint;
+			if(linear)
+			{	double result = 0.;
+				for(int i0=0; i0<2; i0++)
+				for(int i1=0; i1<2; i1++)
+				for(int i2=0; i2<2; i2++)
+					result += term.w[4*i0+2*i1+i2] * term.x[wrappedIndex(ix+vector3<int>(i0,i1,i2),S)];
+				term.y[i] += term.alpha * result;
+			}
+			else term.y[i] += term.alpha * term.x[wrappedIndex(ix,S)];
 		}
+	)
+}
+
+void TranslationOperatorSpline::taxpyBatch(const std::vector<TaxpyTerm>& terms, const ScalarField* x, ScalarField* y) const
+{
+	#ifdef GPU_ENABLED
+	TranslationOperator::taxpyBatch(terms, x, y); //one kernel per term
+	#else
+	std::vector<Stencil> stencils(terms.size());
+	std::vector<SplineTaxpyBatchTerm> batchTerms(terms.size());
+	for(size_t j=0; j<terms.size(); j++)
+	{	const TaxpyTerm& term = terms[j];
+		stencils[j] = getStencil(term.t);
+		nullToZero(y[term.iY], gInfo);
+		SplineTaxpyBatchTerm& bt = batchTerms[j];
+		bt.x = x[term.iX]->data(false);
+		bt.alpha = term.alpha * x[term.iX]->scale;
+		bt.Tint = stencils[j].Tint;
+		bt.w = stencils[j].w;
 	}
+	for(size_t j=0; j<terms.size(); j++) //get output pointers after all allocations (absorbs any scale factor)
+		batchTerms[j].y = y[terms[j].iY]->data();
+	threadLaunch(splineTaxpyBatch_sub, gInfo.nr, gInfo.S, splineType==Linear, &batchTerms);
+	#endif
 }
 
 TranslationOperatorFourier::TranslationOperatorFourier(const GridInfo& gInfo)
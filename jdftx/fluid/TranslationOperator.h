@@ -26,6 +26,16 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/GridInfo.h>
 #include <core/ScalarField.h>
+#include <map>
+#include <mutex>
+
+//! One term of a batched translation: y[iY] += alpha T_t(x[iX]) (see TranslationOperator::taxpyBatch)
+struct TaxpyTerm
+{	vector3<> t; //!< translation
+	double alpha; //!< scale factor
+	int iX, iY; //!< indices of input and output fields
+	TaxpyTerm(const vector3<>& t, double alpha, int iX, int iY) : t(t), alpha(alpha), iX(iX), iY(iY) {}
+};
 
 //! Abstract base class for translation operators
 class TranslationOperator
@@ -41,6 +51,10 @@ public:
 	//! T must conserve integral(x) and satisfy @f$ T^{\dagger}_t = T_{-t} @f$ exactly for gradient correctness
 	//! Note that @f$ T^{-1}_t = T_{-t} @f$ may only be approximately true for some implementations.
 	virtual void taxpy(const vector3<>& t, double alpha, const ScalarField& x, ScalarField& y) const=0;
+	
+	//! Compute y[iY] += alpha T_t(x[iX]) for each term, where x and y are arrays of fields indexed by the terms.
+	//! The default implementation calls taxpy for each term; derived classes may do this in a single pass.
+	virtual void taxpyBatch(const std::vector<TaxpyTerm>& terms, const ScalarField* x, ScalarField* y) const;
 };
 
 //! Translation operator which works in real space using interpolating splines
@@ -55,6 +69,20 @@ public:
 
 	TranslationOperatorSpline(const GridInfo& gInfo, SplineType splineType);
 	void taxpy(const vector3<>& t, double alpha, const ScalarField& x, ScalarField& y) const;
+	void taxpyBatch(const std::vector<TaxpyTerm>& terms, const ScalarField* x, ScalarField* y) const; //!< single pass over the grid for all terms
+	
+private:
+	//! Precomputed integer offset and spline weights for a translation
+	struct Stencil
+	{	vector3<int> Tint; //!< integer part of the (inverse) shift in grid units, reduced to the first cell
+		vector3<> Tfrac; //!< fractional part of the shift (Linear only)
+		double w[8]; //!< interpolation weights of the 2x2x2 neighbours (w[0]=1 for Constant)
+	};
+	mutable std::map<vector3<>,Stencil> stencilCache; //!< stencils keyed by translation (the same set recurs every fluid iteration)
+	static const size_t maxStencils = 1<<14; //!< stencilCache is cleared on reaching this size (bounds memory if the translations do not recur)
+	mutable matrix3<> Rcache; //!< lattice vectors for which stencilCache is valid
+	mutable std::mutex stencilLock; //!< cache access is thread-safe, as orientation loops are threaded
+	Stencil getStencil(const vector3<>& t) const; //!< retrieve stencil from cache, computing if necessary
 };
 
 //! The exact translation operator in PW basis, although much slower and with potential ringing issues
@@ -91,6 +91,7 @@ int main(int argc, char** argv)
 	}
 
 	//Final dump:
+	e.checkpoint.finish(); //complete any pending checkpoint write
 	e.dump(DumpFreq_End, 0);
 	
 	finalizeSystem();
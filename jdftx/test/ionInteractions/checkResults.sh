@@ -0,0 +1,44 @@
+#!/bin/bash
+
+echo "5"  #number of checks
+
+#Reference values from the explicit all-pairs sums over a cube of lattice images
+#(the spherical vdW cutoff of 200 bohr drops ~3e-9 Eh from the cube corners):
+awk '$1=="Eewald" { E = $3 } END { print E, "+0.878143889498 1e-9 Ewald energy [Eh]" }' direct.out
+awk '$1=="EvdW" { E = $3 } END { print E, "-1.171115095e-04 1e-8 vdW energy [Eh]" }' direct.out
+
+#vdW forces (difference in forces with and without vdW) compared to reference:
+paste direct.forces noVdW.forces | awk '
+	BEGIN {
+		split("4.1397511450e-06 2.1436144733e-06 6.8058175320e-07 \
+			2.0625788944e-05 7.5048915184e-06 2.9275076570e-06 \
+			-1.5760103654e-05 -4.9882012181e-06 -2.9200483919e-06 \
+			-9.2924075162e-06 -1.3453850438e-06 -2.1578707210e-06 \
+			6.9752287252e-08 9.6073327210e-08 -1.0403811189e-06 \
+			-7.6778562816e-07 5.4168869877e-07 2.1949825958e-06 \
+			-1.0185151966e-06 -2.4828913368e-06 6.5507736055e-08 \
+			2.0035196181e-06 -1.4697904190e-06 2.4972048981e-07", Fref);
+		nComp = 0; errMax = 0.;
+	}
+	$1=="force" {
+		for(k=0; k<3; k++)
+		{	nComp++;
+			err = ($(3+k) - $(9+k)) - Fref[nComp];
+			if(err<0) err = -err;
+			if(err > errMax) errMax = err;
+		}
+	}
+	END { print errMax, "0 1e-9 vdW force error [Eh/a0]" }'
+
+#Particle-mesh Ewald compared to the direct sum (electronic contributions are identical):
+awk '$1=="Eewald" { E = $3 } END { print E, "+0.878143889498 1e-8 Particle-mesh Ewald energy [Eh]" }' particleMesh.out
+paste particleMesh.forces direct.forces | awk '
+	BEGIN { errMax = 0. }
+	$1=="force" {
+		for(k=0; k<3; k++)
+		{	err = $(3+k) - $(9+k);
+			if(err<0) err = -err;
+			if(err > errMax) errMax = err;
+		}
+	}
+	END { print errMax, "0 1e-7 Particle-mesh force error [Eh/a0]" }'
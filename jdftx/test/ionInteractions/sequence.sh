@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="direct noVdW particleMesh"
+export nProcs="1"
@@ -71,6 +71,8 @@ public:
 	bool saveWfnsRealSpace; //!< whether to output Wannier functions band-by-band in real-space
 	bool saveMomenta; //!< whether to output momentum matrix elements
 	bool loadRotations; //!< whether to load initial rotations from previous dump
+	bool saveOverlaps; //!< whether to write k-mesh overlap matrices (finite-difference localization measure only)
+	bool loadOverlaps; //!< whether to load k-mesh overlap matrices from previous dump, when compatible
 	string initFilename, dumpFilename; //!< filename patterns for input and output
 	
 	string numericalOrbitalsFilename; //!< filename for reading numerical orbitals
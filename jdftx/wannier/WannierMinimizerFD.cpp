@@ -154,6 +154,10 @@ WannierMinimizerFD::WannierMinimizerFD(const Everything& e, const Wannier& wanni
 
 void WannierMinimizerFD::initialize(int iSpin)
 {
+	//Read the overlap matrices for current spin if available:
+	if(wannier.loadOverlaps && loadOverlaps(iSpin))
+		return;
+	
 	//Compute the overlap matrices for current spin:
 	for(int jProcess=0; jProcess<mpiUtil->nProcesses(); jProcess++)
 	{	//Send/recv wavefunctions to other processes:
@@ -179,6 +183,7 @@ void WannierMinimizerFD::initialize(int iSpin)
 		}
 	}
 	Cother.clear();
+	if(wannier.saveOverlaps) saveOverlaps(iSpin);
 	
 	//Broadcast the overlap matrices:
 	for(size_t ik=0; ik<edges.size(); ik++)
@@ -189,6 +194,73 @@ void WannierMinimizerFD::initialize(int iSpin)
 		}
 }
 
+//Overlap file layout: integer header from overlapHeader(), followed by the nBands x nBands
+//overlap matrices of each edge, ordered by k-point in kMesh and then by edge
+std::vector<int> WannierMinimizerFD::overlapHeader() const
+{	std::vector<int> header = { int(kMesh.size()), int(edges[0].size()), nBands };
+	for(const std::vector<Edge>& edgesK: edges)
+		for(const Edge& edge: edgesK)
+		{	header.push_back(edge.ik);
+			for(int j=0; j<3; j++)
+				header.push_back(edge.point.offset[j]);
+		}
+	return header;
+}
+
+bool WannierMinimizerFD::loadOverlaps(int iSpin)
+{	string fname = wannier.getFilename(Wannier::FilenameInit, "mlwfM0", &iSpin);
+	std::vector<int> header = overlapHeader();
+	size_t headerBytes = header.size()*sizeof(int);
+	size_t edgeBytes = nBands*nBands*sizeof(complex);
+	size_t nEdges = edges[0].size();
+	if(fileSize(fname.c_str()) != off_t(headerBytes + kMesh.size()*nEdges*edgeBytes))
+	{	logPrintf("Overlap file '%s' not found or of incompatible size: computing overlaps.\n", fname.c_str());
+		return false;
+	}
+	logPrintf("Reading overlaps from '%s' ... ", fname.c_str()); logFlush();
+	MPIUtil::File fp;
+	mpiUtil->fopenRead(fp, fname.c_str());
+	std::vector<int> headerIn(header.size());
+	mpiUtil->fread(headerIn.data(), sizeof(int), headerIn.size(), fp);
+	if(headerIn != header)
+	{	mpiUtil->fclose(fp);
+		logPrintf("incompatible k-mesh or bands: computing overlaps.\n");
+		return false;
+	}
+	//Read only the overlaps required on this process:
+	for(size_t ik=ikStart; ik<ikStop; ik++)
+	{	mpiUtil->fseek(fp, headerBytes + ik*nEdges*edgeBytes, SEEK_SET);
+		for(Edge& edge: edges[ik])
+		{	edge.M0.init(nBands, nBands);
+			mpiUtil->fread(edge.M0.data(), sizeof(complex), edge.M0.nData(), fp);
+		}
+	}
+	mpiUtil->fclose(fp);
+	logPrintf("done.\n"); logFlush();
+	return true;
+}
+
+void WannierMinimizerFD::saveOverlaps(int iSpin) const
+{	string fname = wannier.getFilename(Wannier::FilenameDump, "mlwfM0", &iSpin);
+	logPrintf("Dumping '%s' ... ", fname.c_str()); logFlush();
+	std::vector<int> header = overlapHeader();
+	size_t headerBytes = header.size()*sizeof(int);
+	size_t edgeBytes = nBands*nBands*sizeof(complex);
+	size_t nEdges = edges[0].size();
+	MPIUtil::File fp;
+	mpiUtil->fopenWrite(fp, fname.c_str());
+	if(mpiUtil->isHead())
+		mpiUtil->fwrite(header.data(), sizeof(int), header.size(), fp);
+	//Each process writes the overlaps it computed:
+	for(size_t ik=0; ik<kMesh.size(); ik++) if(isMine_q(ik,iSpin))
+	{	mpiUtil->fseek(fp, headerBytes + ik*nEdges*edgeBytes, SEEK_SET);
+		for(const Edge& edge: edges[ik])
+			mpiUtil->fwrite(edge.M0.data(), sizeof(complex), edge.M0.nData(), fp);
+	}
+	mpiUtil->fclose(fp);
+	logPrintf("done.\n"); logFlush();
+}
+
 
 double WannierMinimizerFD::getOmega(bool grad)
 {
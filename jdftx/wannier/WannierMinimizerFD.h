@@ -46,6 +46,11 @@ public:
 	};
 	std::vector< std::vector<Edge> > edges; //!< set of all edges
 	matrix kHelmholtzInv; //!< inverse Helmholtz preconditioner
+
+private:
+	std::vector<int> overlapHeader() const; //!< description of k-mesh and edges that identifies a compatible overlap file
+	bool loadOverlaps(int iSpin); //!< read M0 of edges of k-points on this process from file if available and compatible (return true on success)
+	void saveOverlaps(int iSpin) const; //!< write M0 of all edges to file (must be called before M0 is redistributed in initialize)
 };
 
 //! @}
@@ -32,6 +32,8 @@ enum WannierMember
 	WM_saveWfnsRealSpace,
 	WM_saveMomenta,
 	WM_loadRotations,
+	WM_saveOverlaps,
+	WM_loadOverlaps,
 	WM_numericalOrbitals,
 	WM_numericalOrbitalsOffset,
 	WM_phononSup,
@@ -50,6 +52,8 @@ EnumStringMap<WannierMember> wannierMemberMap
 	WM_saveWfnsRealSpace, "saveWfnsRealSpace",
 	WM_saveMomenta, "saveMomenta",
 	WM_loadRotations, "loadRotations",
+	WM_saveOverlaps, "saveOverlaps",
+	WM_loadOverlaps, "loadOverlaps",
 	WM_numericalOrbitals, "numericalOrbitals",
 	WM_numericalOrbitalsOffset, "numericalOrbitalsOffset",
 	WM_phononSup, "phononSupercell",
@@ -113,6 +117,15 @@ struct CommandWannier : public Command
 			"\n+ loadRotations yes|no\n\n"
 			"   Whether to load rotations (.mlwU and .mlwfU2) from a previous %Wannier run.\n"
 			"   Default: no.\n"
+			"\n+ saveOverlaps yes|no\n\n"
+			"   Whether to write the overlap matrices between neighbouring k-points (.mlwfM0)\n"
+			"   used by the FiniteDifference localizationMeasure. Default: no.\n"
+			"\n+ loadOverlaps yes|no\n\n"
+			"   Whether to load the overlap matrices (.mlwfM0) from a previous %Wannier run\n"
+			"   on the same jdftx state, instead of computing them from the wavefunctions.\n"
+			"   This speeds up repeated runs with different trial orbitals or windows.\n"
+			"   The overlaps are recomputed if the file is absent, or if its k-mesh or\n"
+			"   number of bands differs from the present run. Default: no.\n"
 			"\n+ numericalOrbitals <filename>\n\n"
 			"   Load numerical orbitals from <filename> with basis described in <filename>.header\n"
 			"   that can then be used as trial orbitals. The reciprocal space wavefunction output\n"
@@ -175,6 +188,12 @@ struct CommandWannier : public Command
 				case WM_loadRotations:
 					pl.get(wannier.loadRotations, false, boolMap, "loadRotations", true);
 					break;
+				case WM_saveOverlaps:
+					pl.get(wannier.saveOverlaps, false, boolMap, "saveOverlaps", true);
+					break;
+				case WM_loadOverlaps:
+					pl.get(wannier.loadOverlaps, false, boolMap, "loadOverlaps", true);
+					break;
 				case WM_numericalOrbitals:
 					pl.get(wannier.numericalOrbitalsFilename, string(), "filename", true);
 					break;
@@ -206,6 +225,8 @@ struct CommandWannier : public Command
 		logPrintf(" \\\n\tsaveWfnsRealSpace %s", boolMap.getString(wannier.saveWfnsRealSpace));
 		logPrintf(" \\\n\tsaveMomenta %s", boolMap.getString(wannier.saveMomenta));
 		logPrintf(" \\\n\tloadRotations %s", boolMap.getString(wannier.loadRotations));
+		logPrintf(" \\\n\tsaveOverlaps %s", boolMap.getString(wannier.saveOverlaps));
+		logPrintf(" \\\n\tloadOverlaps %s", boolMap.getString(wannier.loadOverlaps));
 		if(wannier.outerWindow)
 		{	logPrintf(" \\\n\touterWindow %lg %lg", wannier.eOuterMin, wannier.eOuterMax);
 			if(wannier.innerWindow)